@@ -4,7 +4,7 @@ namespace FinancialRisk.Api.Models
     {
         public int Id { get; set; }
         public string Symbol { get; set; } = string.Empty;
-        public string CalculationType { get; set; } = string.Empty; // "Historical", "MonteCarlo", "Parametric"
+        public string CalculationType { get; set; } = string.Empty; // "Historical", "MonteCarlo", "Parametric", "FilteredHistorical", "ExtremeValue"
         public string DistributionType { get; set; } = string.Empty; // "Normal", "TStudent", "GARCH", "Copula"
         public double ConfidenceLevel { get; set; }
         public double VaR { get; set; }
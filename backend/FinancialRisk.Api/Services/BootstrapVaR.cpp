@@ -0,0 +1,260 @@
+#include "BootstrapVaR.h"
+#include "QuantileKernels.h"
+#include "RandomStreams.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Replicates handed to a worker at a time
+    const int ReplicateGrain = 32;
+    
+    // Order statistics a replicate needs, worked out once per run
+    struct LevelPlan {
+        std::vector<int> indices;         // VaR order statistic per level
+        std::vector<int> tailCounts;      // ES tail size per level
+        std::vector<int> selectionOrder;  // levels by VaR index, largest first
+        std::vector<int> tailOrder;       // levels by tail size, smallest first
+        int maxTail = 0;
+    };
+    
+    LevelPlan planLevels(const double* confidenceLevels, int numLevels, int length) {
+        LevelPlan plan;
+        for (int level = 0; level < numLevels; ++level) {
+            plan.indices.push_back(RiskKernels::historicalVaRIndex(confidenceLevels[level], length));
+            plan.tailCounts.push_back(RiskKernels::historicalTailCount(confidenceLevels[level], length));
+            plan.selectionOrder.push_back(level);
+            plan.tailOrder.push_back(level);
+            plan.maxTail = std::max(plan.maxTail, plan.tailCounts.back());
+        }
+        std::sort(plan.selectionOrder.begin(), plan.selectionOrder.end(),
+                  [&](int a, int b) { return plan.indices[a] > plan.indices[b]; });
+        std::sort(plan.tailOrder.begin(), plan.tailOrder.end(),
+                  [&](int a, int b) { return plan.tailCounts[a] < plan.tailCounts[b]; });
+        return plan;
+    }
+    
+    // VaR (and optionally CVaR) of every bootstrap replicate at every level.
+    // Outputs hold numLevels x replicates values, row per level. Each replicate
+    // owns its random stream, and each thread reuses one resample buffer; the
+    // levels share one nested selection per replicate, as in selectVaRLevels.
+    void runReplicates(const double* returns, int length, const LevelPlan& plan, int replicates,
+                       unsigned long long seed, double* replicateVaR, double* replicateCVaR) {
+        RiskKernels::parallelFor(replicates, ReplicateGrain, [&](int begin, int end) {
+            thread_local std::vector<double> sample;
+            if (static_cast<int>(sample.size()) < length) sample.resize(length);
+            double* resample = sample.data();
+            
+            for (int r = begin; r < end; ++r) {
+                RiskKernels::RandomStream stream(seed, static_cast<unsigned long long>(r));
+                for (int j = 0; j < length; ++j) {
+                    resample[j] = returns[stream.nextIndex(static_cast<uint32_t>(length))];
+                }
+                
+                int upperBound = length;
+                for (int level : plan.selectionOrder) {
+                    int index = plan.indices[level];
+                    std::nth_element(resample, resample + index, resample + upperBound);
+                    replicateVaR[static_cast<size_t>(level) * replicates + r] = -resample[index];
+                    upperBound = std::max(index, 1);
+                }
+                if (replicateCVaR == nullptr) continue;
+                
+                // Tail sums are prefix sums of the partitioned resample
+                double tailSum = 0.0;
+                size_t next = 0;
+                for (int i = 0; i < plan.maxTail && next < plan.tailOrder.size(); ++i) {
+                    tailSum += resample[i];
+                    while (next < plan.tailOrder.size() && plan.tailCounts[plan.tailOrder[next]] == i + 1) {
+                        int level = plan.tailOrder[next++];
+                        replicateCVaR[static_cast<size_t>(level) * replicates + r] = -(tailSum / (i + 1));
+                    }
+                }
+            }
+        });
+    }
+    
+    // Same outputs as runReplicates, without materializing the resamples. A
+    // replicate's order statistics only depend on how often each sorted
+    // original point is drawn, so the multinomial counts are generated from
+    // the bottom of the sorted sample as conditional binomials (point i gets
+    // Binomial(draws left, 1 / points left)) and the scan stops once the
+    // deepest VaR index and tail of the plan are covered. A replicate costs
+    // O(tail points) instead of O(n).
+    void runCountReplicates(const double* sorted, int length, const LevelPlan& plan, int replicates,
+                            unsigned long long seed, double* replicateVaR, double* replicateCVaR) {
+        const int numLevels = static_cast<int>(plan.indices.size());
+        RiskKernels::parallelFor(replicates, ReplicateGrain, [&](int begin, int end) {
+            for (int r = begin; r < end; ++r) {
+                RiskKernels::RandomStream stream(seed, static_cast<unsigned long long>(r));
+                int nextVaR = numLevels - 1;  // selectionOrder is largest index first
+                int nextTail = replicateCVaR ? 0 : numLevels;
+                int drawn = 0;
+                double tailSum = 0.0;
+                
+                for (int i = 0; i < length && (nextVaR >= 0 || nextTail < numLevels); ++i) {
+                    const int remaining = length - drawn;
+                    const int count = i == length - 1
+                        ? remaining
+                        : stream.nextBinomial(remaining, 1.0 / (length - i));
+                    if (count == 0) continue;
+                    const int covered = drawn + count;
+                    const double value = sorted[i];
+                    
+                    while (nextVaR >= 0 && plan.indices[plan.selectionOrder[nextVaR]] < covered) {
+                        const int level = plan.selectionOrder[nextVaR--];
+                        replicateVaR[static_cast<size_t>(level) * replicates + r] = -value;
+                    }
+                    while (nextTail < numLevels && plan.tailCounts[plan.tailOrder[nextTail]] <= covered) {
+                        const int level = plan.tailOrder[nextTail++];
+                        const int tail = plan.tailCounts[level];
+                        replicateCVaR[static_cast<size_t>(level) * replicates + r] =
+                            -((tailSum + (tail - drawn) * value) / tail);
+                    }
+                    tailSum += count * value;
+                    drawn = covered;
+                }
+            }
+        });
+    }
+    
+    // Index of a percentile among count sorted values, using the rule of the original CI code
+    int percentileIndex(double percentile, int count) {
+        int index = static_cast<int>(percentile * count);
+        if (index >= count) index = count - 1;
+        if (index < 0) index = 0;
+        return index;
+    }
+    
+    // Percentile of the replicate values
+    double replicatePercentile(std::vector<double>& values, double percentile) {
+        int index = percentileIndex(percentile, static_cast<int>(values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+    
+    // Mean, median, standard error and percentiles of one row of replicate
+    // values; sorts the row in place
+    void summarizeReplicates(double* values, int count, const double* percentiles, int numPercentiles,
+                             BootstrapSummary* summary, double* bounds) {
+        // Sequential sums so the summary does not depend on the thread count
+        double sum = 0.0;
+        for (int r = 0; r < count; ++r) sum += values[r];
+        double mean = sum / count;
+        double sumSq = 0.0;
+        for (int r = 0; r < count; ++r) sumSq += (values[r] - mean) * (values[r] - mean);
+        
+        std::sort(values, values + count);
+        if (summary) {
+            summary->mean = mean;
+            summary->median = count % 2 == 1 ? values[count / 2]
+                                             : 0.5 * (values[count / 2 - 1] + values[count / 2]);
+            summary->standardError = count > 1 ? std::sqrt(sumSq / (count - 1)) : 0.0;
+        }
+        if (bounds) {
+            for (int k = 0; k < numPercentiles; ++k) {
+                bounds[k] = values[percentileIndex(percentiles[k], count)];
+            }
+        }
+    }
+}
+
+extern "C" {
+    // Seeded parallel bootstrap VaR
+    double CalculateBootstrapVaRSeeded(double* returns, int length, double confidenceLevel,
+                                       int bootstrapSamples, unsigned long long seed) {
+        if (returns == nullptr || length < 2) return 0.0;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
+        if (bootstrapSamples <= 0) bootstrapSamples = 1000;
+        
+        std::vector<double> replicateVaR(bootstrapSamples);
+        LevelPlan plan = planLevels(&confidenceLevel, 1, length);
+        runReplicates(returns, length, plan, bootstrapSamples, seed, replicateVaR.data(), nullptr);
+        
+        // Sequential sum so the mean does not depend on the thread count
+        double sum = 0.0;
+        for (double var : replicateVaR) {
+            sum += var;
+        }
+        return sum / bootstrapSamples;
+    }
+    
+    // Seeded parallel bootstrap VaR confidence interval
+    void CalculateVaRConfidenceIntervalsSeeded(double* returns, int length, double confidenceLevel,
+                                               int bootstrapSamples, unsigned long long seed,
+                                               double* lowerBound, double* upperBound) {
+        if (lowerBound == nullptr || upperBound == nullptr) return;
+        *lowerBound = 0.0;
+        *upperBound = 0.0;
+        if (returns == nullptr || length < 2 || bootstrapSamples <= 0) return;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return;
+        
+        std::vector<double> replicateVaR(bootstrapSamples);
+        LevelPlan plan = planLevels(&confidenceLevel, 1, length);
+        runReplicates(returns, length, plan, bootstrapSamples, seed, replicateVaR.data(), nullptr);
+        
+        *lowerBound = replicatePercentile(replicateVaR, 0.05);
+        *upperBound = replicatePercentile(replicateVaR, 0.95);
+    }
+    
+    // One bootstrap run summarized at several confidence levels
+    void CalculateBootstrapVaRStatistics(double* returns, int length, double* confidenceLevels, int numLevels,
+                                         int bootstrapSamples, double* percentiles, int numPercentiles,
+                                         int method, unsigned long long seed,
+                                         BootstrapSummary* valueAtRisk, BootstrapSummary* conditionalVaR,
+                                         double* varPercentiles, double* cvarPercentiles) {
+        if (confidenceLevels == nullptr || numLevels <= 0) return;
+        if (percentiles == nullptr) numPercentiles = 0;
+        
+        // Invalid input reports zeros, like the single-level functions
+        const size_t boundCount = static_cast<size_t>(numLevels) * std::max(numPercentiles, 0);
+        for (int level = 0; level < numLevels; ++level) {
+            if (valueAtRisk) valueAtRisk[level] = BootstrapSummary{0.0, 0.0, 0.0};
+            if (conditionalVaR) conditionalVaR[level] = BootstrapSummary{0.0, 0.0, 0.0};
+        }
+        if (varPercentiles) std::fill(varPercentiles, varPercentiles + boundCount, 0.0);
+        if (cvarPercentiles) std::fill(cvarPercentiles, cvarPercentiles + boundCount, 0.0);
+        if (returns == nullptr || length < 2) return;
+        if (bootstrapSamples <= 0) bootstrapSamples = 1000;
+        
+        std::vector<double> levels;
+        std::vector<int> positions;
+        for (int level = 0; level < numLevels; ++level) {
+            if (confidenceLevels[level] > 0.0 && confidenceLevels[level] < 1.0) {
+                levels.push_back(confidenceLevels[level]);
+                positions.push_back(level);
+            }
+        }
+        if (levels.empty()) return;
+        
+        const int valid = static_cast<int>(levels.size());
+        const bool wantCVaR = conditionalVaR != nullptr || cvarPercentiles != nullptr;
+        std::vector<double> replicateVaR(static_cast<size_t>(valid) * bootstrapSamples);
+        std::vector<double> replicateCVaR(wantCVaR ? replicateVaR.size() : 0);
+        LevelPlan plan = planLevels(levels.data(), valid, length);
+        if (method == BOOTSTRAP_SORTED_COUNTS) {
+            std::vector<double> sorted(returns, returns + length);
+            std::sort(sorted.begin(), sorted.end());
+            runCountReplicates(sorted.data(), length, plan, bootstrapSamples, seed, replicateVaR.data(),
+                               wantCVaR ? replicateCVaR.data() : nullptr);
+        } else {
+            runReplicates(returns, length, plan, bootstrapSamples, seed, replicateVaR.data(),
+                          wantCVaR ? replicateCVaR.data() : nullptr);
+        }
+        
+        for (int i = 0; i < valid; ++i) {
+            const int level = positions[i];
+            const size_t row = static_cast<size_t>(i) * bootstrapSamples;
+            const size_t boundRow = static_cast<size_t>(level) * numPercentiles;
+            summarizeReplicates(replicateVaR.data() + row, bootstrapSamples, percentiles, numPercentiles,
+                                valueAtRisk ? valueAtRisk + level : nullptr,
+                                varPercentiles ? varPercentiles + boundRow : nullptr);
+            if (wantCVaR) {
+                summarizeReplicates(replicateCVaR.data() + row, bootstrapSamples, percentiles, numPercentiles,
+                                    conditionalVaR ? conditionalVaR + level : nullptr,
+                                    cvarPercentiles ? cvarPercentiles + boundRow : nullptr);
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef BOOTSTRAP_VAR_H
+#define BOOTSTRAP_VAR_H
+
+// Replicate generation for CalculateBootstrapVaRStatistics
+#define BOOTSTRAP_RESAMPLE 0       // draw n returns per replicate and select
+#define BOOTSTRAP_SORTED_COUNTS 1  // sort once, draw multinomial counts per replicate
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Distribution of one bootstrapped statistic across replicates
+typedef struct BootstrapSummary {
+    double mean;
+    double median;
+    double standardError;  // standard deviation of the replicate values
+} BootstrapSummary;
+
+// Seeded bootstrap of historical VaR. Replicates are split across a thread
+// pool; replicate r draws from its own random stream keyed by (seed, r) into a
+// per-thread scratch buffer and its order statistic is found by selection, not
+// a sort. Results depend only on the inputs and the seed, never on the number
+// of threads. Returns the mean replicate VaR, like CalculateBootstrapVaR.
+double CalculateBootstrapVaRSeeded(double* returns, int length, double confidenceLevel,
+                                   int bootstrapSamples, unsigned long long seed);
+
+// Seeded bootstrap confidence interval of historical VaR: the 5th and 95th
+// percentiles of the replicate VaRs, like CalculateVaRConfidenceIntervals
+void CalculateVaRConfidenceIntervalsSeeded(double* returns, int length, double confidenceLevel,
+                                           int bootstrapSamples, unsigned long long seed,
+                                           double* lowerBound, double* upperBound);
+
+// One seeded bootstrap run for several confidence levels. Each replicate
+// yields VaR and CVaR at every level from one nested selection, and the
+// replicates are summarized into mean, median, standard error and the given
+// percentiles (e.g. 0.05 and 0.95 for a 90% interval; index int(p * samples)
+// of the sorted replicates). valueAtRisk and conditionalVaR receive numLevels
+// summaries; varPercentiles and cvarPercentiles receive numLevels x
+// numPercentiles values (row per level). Levels outside (0, 1) report zeros.
+// Any output may be null.
+//
+// BOOTSTRAP_SORTED_COUNTS sorts the returns once and draws, per replicate,
+// only the multinomial counts of the lowest sorted points up to the deepest
+// tail needed; a replicate then costs O(tail) instead of O(n). It samples the
+// same bootstrap distribution as BOOTSTRAP_RESAMPLE but not the same replicates
+// for a given seed.
+void CalculateBootstrapVaRStatistics(double* returns, int length, double* confidenceLevels, int numLevels,
+                                     int bootstrapSamples, double* percentiles, int numPercentiles,
+                                     int method, unsigned long long seed,
+                                     BootstrapSummary* valueAtRisk, BootstrapSummary* conditionalVaR,
+                                     double* varPercentiles, double* cvarPercentiles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOTSTRAP_VAR_H
@@ -0,0 +1,158 @@
+#ifndef DISTRIBUTION_KERNELS_H
+#define DISTRIBUTION_KERNELS_H
+
+#include <cmath>
+#include <limits>
+
+// Normal and Student-t distribution functions shared by the parametric VaR/ES
+// code of the VaRCalculations and QuantEngine libraries.
+namespace RiskKernels {
+
+    // Standard normal density
+    inline double normalDensity(double x) {
+        return 0.39894228040143267794 * std::exp(-0.5 * x * x);
+    }
+
+    // Standard normal quantile: Wichura's AS241 (PPND16), relative error about
+    // 1e-16 over (0, 1). Returns -inf / +inf at 0 / 1 and NaN outside [0, 1].
+    inline double inverseNormal(double p) {
+        if (!(p >= 0.0 && p <= 1.0)) return std::numeric_limits<double>::quiet_NaN();
+        if (p == 0.0) return -std::numeric_limits<double>::infinity();
+        if (p == 1.0) return std::numeric_limits<double>::infinity();
+
+        const double q = p - 0.5;
+        if (std::fabs(q) <= 0.425) {
+            const double r = 0.180625 - q * q;
+            return q * (((((((2509.0809287301226727 * r + 33430.575583588128105) * r + 67265.770927008700853) * r
+                             + 45921.953931549871457) * r + 13731.693765509461125) * r + 1971.5909503065514427) * r
+                          + 133.14166789178437745) * r + 3.387132872796366608)
+                     / (((((((5226.495278852545925 * r + 28729.085735721942674) * r + 39307.89580009271061) * r
+                            + 21213.794301586595867) * r + 5394.1960214247511077) * r + 687.1870074920579083) * r
+                         + 42.313330701600911252) * r + 1.0);
+        }
+
+        double r = std::sqrt(-std::log(q < 0.0 ? p : 1.0 - p));
+        double value;
+        if (r <= 5.0) {
+            r -= 1.6;
+            value = (((((((7.7454501427834140764e-4 * r + 0.0227238449892691845833) * r + 0.24178072517745061177) * r
+                         + 1.27045825245236838258) * r + 3.64784832476320460504) * r + 5.7694972214606914055) * r
+                      + 4.6303378461565452959) * r + 1.42343711074968357734)
+                    / (((((((1.05075007164441684324e-9 * r + 5.475938084995344946e-4) * r + 0.0151986665636164571966) * r
+                           + 0.14810397642748007459) * r + 0.68976733498510000455) * r + 1.6763848301838038494) * r
+                        + 2.05319162663775882187) * r + 1.0);
+        } else {
+            r -= 5.0;
+            value = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r + 0.0012426609473880784386) * r
+                         + 0.026532189526576123093) * r + 0.29656057182850489123) * r + 1.7848265399172913358) * r
+                      + 5.4637849111641143699) * r + 6.6579046435011037772)
+                    / (((((((2.04426310338993978564e-15 * r + 1.4215117583164458887e-7) * r + 1.8463183175100546818e-5) * r
+                           + 7.868691311456132591e-4) * r + 0.0148753612908506148525) * r + 0.13692988092273580531) * r
+                        + 0.59983220655588793769) * r + 1.0);
+        }
+        return q < 0.0 ? -value : value;
+    }
+
+    // log Gamma(x) for x > 0: Stirling series from x >= 10, reached by the
+    // recurrence Gamma(x) = Gamma(x + 1) / x. Used instead of std::lgamma,
+    // which writes the global signgam under glibc and so races when these
+    // kernels run on several pool threads.
+    inline double logGamma(double x) {
+        double shift = 1.0;
+        while (x < 10.0) {
+            shift *= x;
+            x += 1.0;
+        }
+        const double inverse = 1.0 / x, inverseSq = inverse * inverse;
+        const double series = inverse * (1.0 / 12.0 + inverseSq * (-1.0 / 360.0 + inverseSq * (1.0 / 1260.0
+                            + inverseSq * (-1.0 / 1680.0 + inverseSq * (1.0 / 1188.0 + inverseSq * (-691.0 / 360360.0))))));
+        return (x - 0.5) * std::log(x) - x + 0.91893853320467274178 + series - std::log(shift);
+    }
+
+    // Student-t density with nu degrees of freedom
+    inline double studentTDensity(double x, double nu) {
+        const double logScale = logGamma(0.5 * (nu + 1.0)) - logGamma(0.5 * nu) - 0.5 * std::log(nu * M_PI);
+        return std::exp(logScale - 0.5 * (nu + 1.0) * std::log1p(x * x / nu));
+    }
+
+    // Regularized incomplete beta I_x(a, b) by the Lentz continued fraction,
+    // using the symmetry I_x(a, b) = 1 - I_{1-x}(b, a) where it converges faster
+    inline double incompleteBeta(double x, double a, double b) {
+        if (x <= 0.0) return 0.0;
+        if (x >= 1.0) return 1.0;
+        if (x > (a + 1.0) / (a + b + 2.0)) return 1.0 - incompleteBeta(1.0 - x, b, a);
+
+        const double tiny = 1e-300;
+        const double logFront = logGamma(a + b) - logGamma(a) - logGamma(b)
+                                + a * std::log(x) + b * std::log1p(-x);
+        double c = 1.0;
+        double d = 1.0 - (a + b) * x / (a + 1.0);
+        if (std::fabs(d) < tiny) d = tiny;
+        d = 1.0 / d;
+        double fraction = d;
+        for (int m = 1; m <= 1000; ++m) {
+            for (int half = 0; half < 2; ++half) {
+                const double numerator = half == 0
+                    ? m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m))
+                    : -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+                d = 1.0 + numerator * d;
+                if (std::fabs(d) < tiny) d = tiny;
+                c = 1.0 + numerator / c;
+                if (std::fabs(c) < tiny) c = tiny;
+                d = 1.0 / d;
+                fraction *= d * c;
+            }
+            if (std::fabs(d * c - 1.0) < 1e-15) break;
+        }
+        return std::exp(logFront) * fraction / a;
+    }
+
+    // Upper tail probability P(T > x) of a Student-t, x >= 0
+    inline double studentTUpperTail(double x, double nu) {
+        return 0.5 * incompleteBeta(nu / (nu + x * x), 0.5 * nu, 0.5);
+    }
+
+    // Student-t quantile for nu > 1: Hill's algorithm 396 start (as in R's qt)
+    // and Newton steps on the upper tail
+    inline double studentTQuantile(double p, double nu) {
+        if (!(p > 0.0 && p < 1.0) || !(nu > 1.0)) return std::numeric_limits<double>::quiet_NaN();
+        if (p == 0.5) return 0.0;
+        const double tail = p < 0.5 ? p : 1.0 - p;
+        const double twoSided = 2.0 * tail;
+
+        double quantile;
+        if (std::fabs(nu - 2.0) < 1e-12) {
+            quantile = std::sqrt(2.0 / (twoSided * (2.0 - twoSided)) - 2.0);
+        } else {
+            const double a = 1.0 / (nu - 0.5);
+            const double b = 48.0 / (a * a);
+            double c = ((20700.0 * a / b - 98.0) * a - 16.0) * a + 96.36;
+            const double d = ((94.5 / (b + c) - 3.0) / b + 1.0) * std::sqrt(a * M_PI_2) * nu;
+            double y = std::pow(d * twoSided, 2.0 / nu);
+            if (y > 0.05 + a) {
+                // Asymptotic inverse expansion about the normal
+                const double x = inverseNormal(0.5 * twoSided);
+                y = x * x;
+                if (nu < 5.0) c += 0.3 * (nu - 4.5) * (x + 0.6);
+                c = (((0.05 * d * x - 5.0) * x - 7.0) * x - 2.0) * x + b + c;
+                y = (((((0.4 * y + 6.3) * y + 36.0) * y + 94.5) / c - y - 3.0) / b + 1.0) * x;
+                y = std::expm1(a * y * y);
+            } else {
+                y = ((1.0 / (((nu + 6.0) / (nu * y) - 0.089 * d - 0.822) * (nu + 2.0) * 3.0) + 0.5 / (nu + 4.0)) * y
+                     - 1.0) * (nu + 1.0) / (nu + 2.0) + 1.0 / y;
+            }
+            quantile = std::sqrt(nu * y);
+        }
+
+        for (int step = 0; step < 4; ++step) {
+            const double density = studentTDensity(quantile, nu);
+            if (!(density > 0.0)) break;
+            const double correction = (studentTUpperTail(quantile, nu) - tail) / density;
+            quantile += correction;
+            if (std::fabs(correction) <= 1e-14 * quantile) break;
+        }
+        return p < 0.5 ? -quantile : quantile;
+    }
+}
+
+#endif // DISTRIBUTION_KERNELS_H
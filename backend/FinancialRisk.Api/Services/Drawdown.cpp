@@ -0,0 +1,91 @@
+#include "Drawdown.h"
+#include "DrawdownQueue.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Additive drawdown is peak - level. Compounded drawdown is tracked on log
+    // wealth, where the same queue applies and 1 - exp(-x) converts back.
+    void rollingMaximumDrawdown(const double* returns, int length, int mode, int windowLength, double* output) {
+        const bool compounded = mode == DRAWDOWN_COMPOUNDED;
+        RiskKernels::DrawdownQueue levels;
+        double level = 0.0;
+        levels.push(level);
+        
+        for (int t = 0; t < length; ++t) {
+            level += compounded ? std::log1p(returns[t]) : returns[t];
+            levels.push(level);
+            if (static_cast<int>(levels.size()) > windowLength + 1) {
+                levels.pop();
+            }
+            if (t + 1 < windowLength) {
+                output[t] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            double drawdown = levels.maximumDrawdown();
+            output[t] = compounded ? -std::expm1(-drawdown) : drawdown;
+        }
+    }
+}
+
+extern "C" {
+    // Calculate drawdown analytics and optional rolling maximum drawdown
+    void CalculateDrawdownAnalytics(double* returns, int length, int mode, int windowLength,
+                                    DrawdownAnalytics* analytics, double* rollingMaxDrawdown) {
+        if (returns == nullptr || length <= 0) return;
+        const bool compounded = mode == DRAWDOWN_COMPOUNDED;
+        
+        if (analytics) {
+            double level = compounded ? 1.0 : 0.0;
+            double peak = level;
+            int peakIndex = -1;
+            
+            DrawdownAnalytics result = {0.0, -1, -1, -1, 0, 0.0, 0.0};
+            bool awaitingRecovery = false;
+            int underwater = 0;
+            double sumSquaredDrawdown = 0.0;
+            
+            for (int t = 0; t < length; ++t) {
+                level = compounded ? level * (1.0 + returns[t]) : level + returns[t];
+                
+                if (level >= peak) {
+                    if (awaitingRecovery) {
+                        result.recoveryIndex = t;
+                        awaitingRecovery = false;
+                    }
+                    peak = level;
+                    peakIndex = t;
+                    underwater = 0;
+                    continue;
+                }
+                
+                double drawdown = compounded ? 1.0 - level / peak : peak - level;
+                sumSquaredDrawdown += drawdown * drawdown;
+                if (++underwater > result.longestUnderwaterDuration) {
+                    result.longestUnderwaterDuration = underwater;
+                }
+                if (drawdown > result.maximumDrawdown) {
+                    result.maximumDrawdown = drawdown;
+                    result.peakIndex = peakIndex;
+                    result.troughIndex = t;
+                    result.recoveryIndex = -1;
+                    awaitingRecovery = true;
+                }
+            }
+            
+            // Annualized return over the whole series, in the same convention as the levels
+            double annualizedReturn = compounded
+                ? (level > 0.0 ? std::pow(level, 252.0 / length) - 1.0 : -1.0)
+                : level * 252.0 / length;
+            if (result.maximumDrawdown > 0.0) {
+                result.calmarRatio = annualizedReturn / result.maximumDrawdown;
+            }
+            result.ulcerIndex = std::sqrt(sumSquaredDrawdown / length);
+            *analytics = result;
+        }
+        
+        if (rollingMaxDrawdown && windowLength > 0) {
+            rollingMaximumDrawdown(returns, length, mode, windowLength, rollingMaxDrawdown);
+        }
+    }
+}
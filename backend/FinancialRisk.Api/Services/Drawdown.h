@@ -0,0 +1,35 @@
+#ifndef DRAWDOWN_H
+#define DRAWDOWN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// How cumulative levels are formed from returns
+#define DRAWDOWN_ADDITIVE 0    // level = sum of returns, drawdown = peak - level (as CalculateMaximumDrawdown)
+#define DRAWDOWN_COMPOUNDED 1  // level = product of (1 + r), drawdown = 1 - level / peak
+
+// Drawdown statistics for one return series. Indices refer to the level after
+// returns[index]; -1 is the starting level before the first return.
+typedef struct DrawdownAnalytics {
+    double maximumDrawdown;
+    int peakIndex;                  // peak preceding the maximum drawdown
+    int troughIndex;                // trough of the maximum drawdown
+    int recoveryIndex;              // first index back at the peak, -1 if not recovered
+    int longestUnderwaterDuration;  // longest run of periods below the running peak
+    double calmarRatio;             // annualized return / maximum drawdown
+    double ulcerIndex;              // root mean square of the drawdown series
+} DrawdownAnalytics;
+
+// Calculate drawdown analytics in one O(length) pass. If rollingMaxDrawdown is
+// not null and windowLength > 0, it receives length values: element t is the
+// maximum drawdown over returns (t - windowLength, t], measured from the level
+// before the window, and elements before the first full window are NaN.
+void CalculateDrawdownAnalytics(double* returns, int length, int mode, int windowLength,
+                                DrawdownAnalytics* analytics, double* rollingMaxDrawdown);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DRAWDOWN_H
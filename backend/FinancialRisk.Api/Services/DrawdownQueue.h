@@ -0,0 +1,76 @@
+#ifndef DRAWDOWN_QUEUE_H
+#define DRAWDOWN_QUEUE_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Sliding-window maximum drawdown shared by the streaming accumulator and the
+// drawdown analytics. Levels are cumulative (additive) returns or log wealth.
+namespace RiskKernels {
+
+    // Peak-to-trough summary of a time-ordered run of cumulative return levels
+    struct DrawdownSummary {
+        double high;
+        double low;
+        double drawdown; // largest fall from an earlier high to a later low
+    };
+    
+    inline DrawdownSummary singleLevel(double level) {
+        return DrawdownSummary{level, level, 0.0};
+    }
+    
+    // Summary of 'older' followed by 'newer'
+    inline DrawdownSummary combineDrawdowns(const DrawdownSummary& older, const DrawdownSummary& newer) {
+        return DrawdownSummary{
+            std::max(older.high, newer.high),
+            std::min(older.low, newer.low),
+            std::max({older.drawdown, newer.drawdown, older.high - newer.low})
+        };
+    }
+    
+    // Queue of cumulative levels with O(1) amortized push/pop and O(1) max
+    // drawdown query (two stacks, each entry caching the summary of its stack)
+    class DrawdownQueue {
+    public:
+        void push(double level) {
+            DrawdownSummary summary = back.empty() ? singleLevel(level) : combineDrawdowns(back.back().second, singleLevel(level));
+            back.emplace_back(level, summary);
+        }
+        
+        void pop() {
+            if (front.empty()) {
+                // Move the newest-first back stack over so the oldest level ends on top
+                while (!back.empty()) {
+                    double level = back.back().first;
+                    back.pop_back();
+                    DrawdownSummary summary = front.empty() ? singleLevel(level) : combineDrawdowns(singleLevel(level), front.back().second);
+                    front.emplace_back(level, summary);
+                }
+            }
+            if (!front.empty()) front.pop_back();
+        }
+        
+        double maximumDrawdown() const {
+            if (front.empty() && back.empty()) return 0.0;
+            if (front.empty()) return back.back().second.drawdown;
+            if (back.empty()) return front.back().second.drawdown;
+            return combineDrawdowns(front.back().second, back.back().second).drawdown;
+        }
+        
+        size_t size() const {
+            return front.size() + back.size();
+        }
+        
+        void clear() {
+            front.clear();
+            back.clear();
+        }
+        
+    private:
+        std::vector<std::pair<double, DrawdownSummary>> front; // top = oldest
+        std::vector<std::pair<double, DrawdownSummary>> back;  // top = newest
+    };
+}
+
+#endif // DRAWDOWN_QUEUE_H
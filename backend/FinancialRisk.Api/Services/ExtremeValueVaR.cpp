@@ -0,0 +1,240 @@
+#include "ExtremeValueVaR.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+namespace {
+    const double DefaultThresholdFraction = 0.1;
+    const int MinimumExceedances = 10;
+    const double MinimumShape = -0.5;
+    // Series handed to a worker at a time
+    const int AssetGrain = 4;
+    // Profile grid: theta times the largest exceedance (theta > -1 / max y)
+    const double ThetaGrid[] = {-0.999, -0.99, -0.95, -0.9, -0.8, -0.6, -0.4, -0.2, -0.05, 0.05,
+                                0.2, 0.5, 1.0, 2.0, 5.0, 10.0, 30.0, 100.0, 300.0, 1000.0, 10000.0};
+    const int GridPoints = sizeof(ThetaGrid) / sizeof(ThetaGrid[0]);
+    
+    // log(1 + x) / x and its derivative, by series near 0 where both cancel
+    double logRatio(double x) {
+        if (std::fabs(x) < 1e-3) return 1.0 + x * (-0.5 + x * (1.0 / 3.0 + x * (-0.25 + x * 0.2)));
+        return std::log1p(x) / x;
+    }
+    
+    double logRatioDerivative(double x) {
+        if (std::fabs(x) < 1e-3) return -0.5 + x * (2.0 / 3.0 + x * (-0.75 + x * (0.8 - x * 5.0 / 6.0)));
+        return (x / (1.0 + x) - std::log1p(x)) / (x * x);
+    }
+    
+    // Profile likelihood of exceedances y[0, k) at theta = xi / beta. With
+    // beta(theta) = mean of log(1 + theta y) / theta and xi = theta beta, the
+    // log-likelihood per exceedance is -log(beta) - xi - 1; gradient is its
+    // derivative in theta.
+    struct ProfilePoint {
+        double theta;
+        double scale;
+        double shape;
+        double logLikelihood;
+        double gradient;
+    };
+    
+    ProfilePoint profileAt(const double* y, int k, double theta) {
+        double sum = 0.0, slopeSum = 0.0;
+        for (int i = 0; i < k; ++i) {
+            const double x = theta * y[i];
+            sum += y[i] * logRatio(x);
+            slopeSum += y[i] * y[i] * logRatioDerivative(x);
+        }
+        const double scale = sum / k, slope = slopeSum / k;
+        const double shape = theta * scale;
+        return ProfilePoint{theta, scale, shape, -std::log(scale) - shape - 1.0,
+                            -slope / scale - scale - theta * slope};
+    }
+    
+    // Maximum likelihood GPD fit of exceedances y[0, k)
+    bool fitExceedances(const double* y, int k, GpdTailFit& fit) {
+        const double yMax = *std::max_element(y, y + k);
+        if (!(yMax > 0.0)) return false;
+        
+        // Best grid point in the regular region; shape grows with theta, so the
+        // region is a suffix of the grid
+        ProfilePoint grid[GridPoints];
+        int best = -1;
+        for (int j = 0; j < GridPoints; ++j) {
+            grid[j] = profileAt(y, k, ThetaGrid[j] / yMax);
+            if (grid[j].shape < MinimumShape) continue;
+            if (best < 0 || grid[j].logLikelihood > grid[best].logLikelihood) best = j;
+        }
+        if (best < 0) return false;
+        
+        // Illinois root search of the gradient between the neighbours
+        ProfilePoint result = grid[best];
+        ProfilePoint lo = grid[best > 0 && grid[best - 1].shape >= MinimumShape ? best - 1 : best];
+        ProfilePoint hi = grid[std::min(best + 1, GridPoints - 1)];
+        if (lo.gradient > 0.0 && hi.gradient < 0.0) {
+            double a = lo.theta, b = hi.theta, ga = lo.gradient, gb = hi.gradient;
+            int side = 0;
+            for (int iteration = 0; iteration < 100; ++iteration) {
+                const double c = (a * gb - b * ga) / (gb - ga);
+                const ProfilePoint point = profileAt(y, k, c);
+                if (point.logLikelihood > result.logLikelihood) result = point;
+                if (point.gradient == 0.0 || std::fabs(b - a) * yMax < 1e-12) break;
+                if (point.gradient < 0.0) {
+                    b = c;
+                    gb = point.gradient;
+                    if (side == -1) ga *= 0.5;
+                    side = -1;
+                } else {
+                    a = c;
+                    ga = point.gradient;
+                    if (side == 1) gb *= 0.5;
+                    side = 1;
+                }
+            }
+        }
+        
+        fit.shape = result.shape;
+        fit.scale = result.scale;
+        fit.exceedances = k;
+        fit.logLikelihood = k * result.logLikelihood;
+        return true;
+    }
+    
+    // Exceedance count for a threshold fraction, 0 if too few
+    int exceedanceCount(double thresholdFraction, int length) {
+        if (thresholdFraction <= 0.0) thresholdFraction = DefaultThresholdFraction;
+        const int k = std::min(static_cast<int>(thresholdFraction * length), length - 1);
+        return k >= MinimumExceedances ? k : 0;
+    }
+    
+    // The count largest losses of the series, in descending order
+    void largestLosses(const double* returns, int length, int count, std::vector<double>& losses) {
+        losses.resize(length);
+        for (int t = 0; t < length; ++t) losses[t] = -returns[t];
+        std::nth_element(losses.begin(), losses.begin() + (count - 1), losses.end(), std::greater<double>());
+        std::sort(losses.begin(), losses.begin() + count, std::greater<double>());
+    }
+    
+    // Fit over the threshold losses[k], given descending losses[0, k]
+    bool fitTail(const std::vector<double>& losses, int k, GpdTailFit& fit) {
+        fit = GpdTailFit{0.0, 0.0, 0.0, 0, 0.0};
+        thread_local std::vector<double> exceedances;
+        exceedances.resize(k);
+        const double threshold = losses[k];
+        for (int i = 0; i < k; ++i) exceedances[i] = losses[i] - threshold;
+        if (!fitExceedances(exceedances.data(), k, fit)) {
+            fit = GpdTailFit{0.0, 0.0, 0.0, 0, 0.0};
+            return false;
+        }
+        fit.threshold = threshold;
+        return true;
+    }
+    
+    // POT VaR at tail probability tail (< k / n), and ES if finite (else 0)
+    void tailRisk(const GpdTailFit& fit, int length, double tail, double& var, double& es) {
+        const double logRatioOfTails = std::log(static_cast<double>(length) / fit.exceedances * tail);
+        const double growth = fit.shape != 0.0 ? std::expm1(-fit.shape * logRatioOfTails) / fit.shape : -logRatioOfTails;
+        var = fit.threshold + fit.scale * growth;
+        es = fit.shape < 1.0 ? (var + fit.scale - fit.shape * fit.threshold) / (1.0 - fit.shape) : 0.0;
+    }
+    
+    // CalculateExtremeValueVaR body, writing numLevels values to each output
+    void extremeValueSeries(const double* returns, int length, double thresholdFraction,
+                            const double* confidenceLevels, int numLevels,
+                            double* valueAtRisk, double* expectedShortfall, GpdTailFit* fitOut) {
+        if (valueAtRisk) std::fill(valueAtRisk, valueAtRisk + numLevels, 0.0);
+        if (expectedShortfall) std::fill(expectedShortfall, expectedShortfall + numLevels, 0.0);
+        GpdTailFit fit{0.0, 0.0, 0.0, 0, 0.0};
+        const int k = exceedanceCount(thresholdFraction, length);
+        thread_local std::vector<double> losses;
+        if (k > 0) {
+            largestLosses(returns, length, k + 1, losses);
+            fitTail(losses, k, fit);
+        }
+        if (fitOut) *fitOut = fit;
+        if (fit.exceedances == 0) return;
+        
+        for (int level = 0; level < numLevels; ++level) {
+            const double tail = 1.0 - confidenceLevels[level];
+            if (!(tail > 0.0 && tail < static_cast<double>(k) / length)) continue;
+            double var = 0.0, es = 0.0;
+            tailRisk(fit, length, tail, var, es);
+            if (valueAtRisk) valueAtRisk[level] = var;
+            if (expectedShortfall) expectedShortfall[level] = es;
+        }
+    }
+}
+
+extern "C" {
+    // Peaks-over-threshold GPD fit
+    int FitGPDTail(double* returns, int length, double thresholdFraction, GpdTailFit* fit) {
+        if (returns == nullptr || fit == nullptr) return 0;
+        *fit = GpdTailFit{0.0, 0.0, 0.0, 0, 0.0};
+        const int k = exceedanceCount(thresholdFraction, length);
+        if (k == 0) return 0;
+        std::vector<double> losses;
+        largestLosses(returns, length, k + 1, losses);
+        return fitTail(losses, k, *fit) ? 1 : 0;
+    }
+    
+    // POT VaR/ES at several confidence levels
+    void CalculateExtremeValueVaR(double* returns, int length, double thresholdFraction,
+                                  double* confidenceLevels, int numLevels,
+                                  double* valueAtRisk, double* expectedShortfall, GpdTailFit* fit) {
+        if (returns == nullptr || confidenceLevels == nullptr || numLevels <= 0) return;
+        extremeValueSeries(returns, length, thresholdFraction, confidenceLevels, numLevels,
+                           valueAtRisk, expectedShortfall, fit);
+    }
+    
+    // POT VaR/ES for many series
+    void CalculateBatchExtremeValueVaR(double* assetReturns, int numAssets, int length, double thresholdFraction,
+                                       double* confidenceLevels, int numLevels,
+                                       double* valueAtRisk, double* expectedShortfall, GpdTailFit* fits) {
+        if (assetReturns == nullptr || confidenceLevels == nullptr || numAssets <= 0 || numLevels <= 0) return;
+        RiskKernels::parallelFor(numAssets, AssetGrain, [&](int begin, int end) {
+            for (int asset = begin; asset < end; ++asset) {
+                const size_t row = static_cast<size_t>(asset) * numLevels;
+                extremeValueSeries(assetReturns + static_cast<size_t>(asset) * length, length, thresholdFraction,
+                                   confidenceLevels, numLevels,
+                                   valueAtRisk ? valueAtRisk + row : nullptr,
+                                   expectedShortfall ? expectedShortfall + row : nullptr,
+                                   fits ? fits + asset : nullptr);
+            }
+        });
+    }
+    
+    // GPD parameters and VaR across thresholds
+    void CalculateGPDThresholdStability(double* returns, int length, double* thresholdFractions, int numThresholds,
+                                        double confidenceLevel, double* shape, double* shapeStandardError,
+                                        double* modifiedScale, double* valueAtRisk) {
+        if (returns == nullptr || thresholdFractions == nullptr || numThresholds <= 0) return;
+        for (double* output : {shape, shapeStandardError, modifiedScale, valueAtRisk}) {
+            if (output) std::fill(output, output + numThresholds, 0.0);
+        }
+        
+        // One partial sort covers the lowest threshold
+        int largest = 0;
+        for (int i = 0; i < numThresholds; ++i) {
+            if (thresholdFractions[i] > 0.0) largest = std::max(largest, exceedanceCount(thresholdFractions[i], length));
+        }
+        if (largest == 0) return;
+        std::vector<double> losses;
+        largestLosses(returns, length, largest + 1, losses);
+        
+        const double tail = 1.0 - confidenceLevel;
+        for (int i = 0; i < numThresholds; ++i) {
+            if (!(thresholdFractions[i] > 0.0)) continue;
+            const int k = exceedanceCount(thresholdFractions[i], length);
+            GpdTailFit fit;
+            if (k == 0 || !fitTail(losses, k, fit)) continue;
+            if (shape) shape[i] = fit.shape;
+            if (shapeStandardError) shapeStandardError[i] = (1.0 + fit.shape) / std::sqrt(static_cast<double>(k));
+            if (modifiedScale) modifiedScale[i] = fit.scale - fit.shape * fit.threshold;
+            if (valueAtRisk && tail > 0.0 && tail < static_cast<double>(k) / length) {
+                double es = 0.0;
+                tailRisk(fit, length, tail, valueAtRisk[i], es);
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef EXTREME_VALUE_VAR_H
+#define EXTREME_VALUE_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Generalized Pareto fit of the loss tail over a threshold:
+//   P(L - u > y | L > u) = (1 + shape y / scale)^(-1 / shape)
+typedef struct GpdTailFit {
+    double threshold;      // loss threshold u (losses are -returns)
+    double shape;          // xi; > 0 heavy tail, 0 exponential, < 0 bounded
+    double scale;          // beta
+    int exceedances;       // k, losses above the threshold
+    double logLikelihood;
+} GpdTailFit;
+
+// Fit a GPD to the thresholdFraction x length largest losses of a return
+// series (peaks over threshold). The threshold is the next largest loss. The
+// maximum likelihood fit runs on the profile likelihood in theta = xi / beta,
+// where xi has a closed form: a grid over theta, then a bracketed root search
+// of the analytic profile gradient. xi is kept >= -0.5, the region where the
+// estimator is regular. thresholdFraction <= 0 uses 0.1. Returns 0 (fit
+// zeroed) if fewer than 10 losses exceed the threshold, the largest exceedance
+// is not positive (every exceedance is zero), or no fit has xi >= -0.5.
+// Equal nonzero exceedances are fitted like any other sample.
+int FitGPDTail(double* returns, int length, double thresholdFraction, GpdTailFit* fit);
+
+// POT VaR and ES of one series at several confidence levels. With n = length:
+//   VaR = u + beta / xi ((n / k (1 - c))^(-xi) - 1)    (u - beta log(n / k (1 - c)) as xi -> 0)
+//   ES  = (VaR + beta - xi u) / (1 - xi)
+// Levels outside (0, 1), levels whose tail 1 - c is not beyond the threshold
+// (1 - c >= k / n) and ES with xi >= 1 (infinite mean) report 0, as does a
+// failed fit. Any output may be null.
+void CalculateExtremeValueVaR(double* returns, int length, double thresholdFraction,
+                              double* confidenceLevels, int numLevels,
+                              double* valueAtRisk, double* expectedShortfall, GpdTailFit* fit);
+
+// CalculateExtremeValueVaR for numAssets series of length observations stored
+// one after another, split across a thread pool. Outputs are numAssets x
+// numLevels, row-major; fits (numAssets entries) may be null.
+void CalculateBatchExtremeValueVaR(double* assetReturns, int numAssets, int length, double thresholdFraction,
+                                   double* confidenceLevels, int numLevels,
+                                   double* valueAtRisk, double* expectedShortfall, GpdTailFit* fits);
+
+// Threshold-stability diagnostic: the GPD is refitted for each threshold
+// fraction from one sort of the largest losses. Above a threshold where the
+// GPD holds, the shape and the modified scale beta - xi u stay flat and so
+// does VaR at confidenceLevel; a drift shows the threshold is too low. Each
+// output receives numThresholds values (0 where the fit fails) and may be
+// null. shapeStandardError is the asymptotic (1 + xi) / sqrt(k).
+void CalculateGPDThresholdStability(double* returns, int length, double* thresholdFractions, int numThresholds,
+                                    double confidenceLevel, double* shape, double* shapeStandardError,
+                                    double* modifiedScale, double* valueAtRisk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXTREME_VALUE_VAR_H
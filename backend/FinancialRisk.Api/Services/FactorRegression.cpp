@@ -0,0 +1,195 @@
+#include "FactorRegression.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Assets handled together by the cross-product kernel, and the number of
+    // observations per tile: a tile of the block's series stays in L1 while it
+    // is multiplied against every factor
+    const int AssetBlock = 4;
+    const int TimeTile = 512;
+    const int Lanes = 4;
+    
+    // In-place lower Cholesky factor of a row-major k x k Gram matrix. Returns
+    // false if a pivot collapses relative to its diagonal (collinear factors).
+    bool choleskyFactor(std::vector<double>& a, int k) {
+        for (int j = 0; j < k; ++j) {
+            const double original = a[j * k + j];
+            double pivot = original;
+            for (int p = 0; p < j; ++p) {
+                pivot -= a[j * k + p] * a[j * k + p];
+            }
+            if (!(pivot > 1e-12 * original)) return false;
+            const double diagonal = std::sqrt(pivot);
+            a[j * k + j] = diagonal;
+            for (int i = j + 1; i < k; ++i) {
+                double value = a[i * k + j];
+                for (int p = 0; p < j; ++p) {
+                    value -= a[i * k + p] * a[j * k + p];
+                }
+                a[i * k + j] = value / diagonal;
+            }
+        }
+        return true;
+    }
+    
+    // Solve L L' x = b in place, with L from choleskyFactor
+    void choleskySolve(const std::vector<double>& l, int k, double* x) {
+        for (int i = 0; i < k; ++i) {
+            double value = x[i];
+            for (int p = 0; p < i; ++p) value -= l[i * k + p] * x[p];
+            x[i] = value / l[i * k + i];
+        }
+        for (int i = k - 1; i >= 0; --i) {
+            double value = x[i];
+            for (int p = i + 1; p < k; ++p) value -= l[p * k + i] * x[p];
+            x[i] = value / l[i * k + i];
+        }
+    }
+    
+    // sum(x[t] * y[t]) over [begin, end) with independent lane accumulators
+    // so the loop vectorizes without reassociation flags
+    inline double tileDot(const double* x, const double* y, int begin, int end) {
+        double lanes[Lanes] = {0.0, 0.0, 0.0, 0.0};
+        int t = begin;
+        for (; t + Lanes <= end; t += Lanes) {
+            for (int l = 0; l < Lanes; ++l) {
+                lanes[l] += x[t + l] * y[t + l];
+            }
+        }
+        for (; t < end; ++t) {
+            lanes[0] += x[t] * y[t];
+        }
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+    
+    // Cross products of the centered factors with up to AssetBlock asset series
+    // (cross is numFactors x AssetBlock), plus each series' sums shifted by its
+    // first value for the total sum of squares
+    void crossProductBlock(const double* centeredFactors, int numFactors, int length,
+                           const double* const* series, int width,
+                           double* cross, double* shiftedSum, double* shiftedSumSq) {
+        std::fill(cross, cross + numFactors * AssetBlock, 0.0);
+        for (int j = 0; j < width; ++j) {
+            shiftedSum[j] = shiftedSumSq[j] = 0.0;
+        }
+        
+        for (int begin = 0; begin < length; begin += TimeTile) {
+            const int end = std::min(length, begin + TimeTile);
+            for (int j = 0; j < width; ++j) {
+                const double* y = series[j];
+                const double shift = y[0];
+                double sum = 0.0, sumSq = 0.0;
+                for (int t = begin; t < end; ++t) {
+                    double diff = y[t] - shift;
+                    sum += diff;
+                    sumSq += diff * diff;
+                }
+                shiftedSum[j] += sum;
+                shiftedSumSq[j] += sumSq;
+            }
+            for (int p = 0; p < numFactors; ++p) {
+                const double* x = centeredFactors + static_cast<size_t>(p) * length;
+                for (int j = 0; j < width; ++j) {
+                    cross[p * AssetBlock + j] += tileDot(x, series[j], begin, end);
+                }
+            }
+        }
+    }
+}
+
+extern "C" {
+    // Regress every asset on the same set of factors
+    int CalculateFactorExposures(double* assetReturns, double* factorReturns, int numObservations,
+                                 int numAssets, int numFactors, double* alpha, double* betas,
+                                 double* residualVolatility, double* rSquared) {
+        if (assetReturns == nullptr || factorReturns == nullptr || numAssets <= 0 || numFactors <= 0) return 0;
+        
+        auto zeroOutputs = [&]() {
+            for (double* output : {alpha, residualVolatility, rSquared}) {
+                if (output) std::fill(output, output + numAssets, 0.0);
+            }
+            if (betas) std::fill(betas, betas + static_cast<size_t>(numAssets) * numFactors, 0.0);
+        };
+        if (numObservations <= numFactors + 1) {
+            zeroOutputs();
+            return 0;
+        }
+        
+        // Center the factors once; with centered regressors the intercept drops
+        // out of the normal equations and the Gram matrix is better conditioned
+        const int length = numObservations;
+        const double n = static_cast<double>(length);
+        std::vector<double> factorMeans(numFactors);
+        std::vector<double> centered(factorReturns, factorReturns + static_cast<size_t>(numFactors) * length);
+        for (int p = 0; p < numFactors; ++p) {
+            double* x = centered.data() + static_cast<size_t>(p) * length;
+            double sum = 0.0;
+            for (int t = 0; t < length; ++t) sum += x[t];
+            factorMeans[p] = sum / n;
+            for (int t = 0; t < length; ++t) x[t] -= factorMeans[p];
+        }
+        
+        std::vector<double> gram(static_cast<size_t>(numFactors) * numFactors);
+        for (int p = 0; p < numFactors; ++p) {
+            const double* x = centered.data() + static_cast<size_t>(p) * length;
+            for (int q = 0; q <= p; ++q) {
+                const double* y = centered.data() + static_cast<size_t>(q) * length;
+                gram[p * numFactors + q] = gram[q * numFactors + p] = tileDot(x, y, 0, length);
+            }
+        }
+        if (!choleskyFactor(gram, numFactors)) {
+            zeroOutputs();
+            return 0;
+        }
+        
+        const double residualDegrees = n - numFactors - 1;
+        const double annualization = std::sqrt(252.0);
+        
+        RiskKernels::parallelFor(numAssets, 4 * AssetBlock, [&](int begin, int end) {
+            std::vector<double> cross(static_cast<size_t>(numFactors) * AssetBlock);
+            std::vector<double> coefficients(numFactors);
+            double shiftedSum[AssetBlock], shiftedSumSq[AssetBlock];
+            const double* series[AssetBlock];
+            
+            for (int blockStart = begin; blockStart < end; blockStart += AssetBlock) {
+                const int width = std::min(end, blockStart + AssetBlock) - blockStart;
+                for (int j = 0; j < width; ++j) {
+                    series[j] = assetReturns + static_cast<size_t>(blockStart + j) * length;
+                }
+                crossProductBlock(centered.data(), numFactors, length, series, width,
+                                  cross.data(), shiftedSum, shiftedSumSq);
+                
+                for (int j = 0; j < width; ++j) {
+                    const int asset = blockStart + j;
+                    for (int p = 0; p < numFactors; ++p) {
+                        coefficients[p] = cross[p * AssetBlock + j];
+                    }
+                    choleskySolve(gram, numFactors, coefficients.data());
+                    
+                    // Explained sum of squares is c'beta, with c = Xc'y
+                    double totalSumSq = std::max(0.0, shiftedSumSq[j] - shiftedSum[j] * shiftedSum[j] / n);
+                    double explained = 0.0, fittedMean = 0.0;
+                    for (int p = 0; p < numFactors; ++p) {
+                        explained += cross[p * AssetBlock + j] * coefficients[p];
+                        fittedMean += coefficients[p] * factorMeans[p];
+                    }
+                    double residualSumSq = std::max(0.0, totalSumSq - explained);
+                    
+                    if (betas) {
+                        std::copy(coefficients.begin(), coefficients.end(), betas + static_cast<size_t>(asset) * numFactors);
+                    }
+                    if (alpha) alpha[asset] = series[j][0] + shiftedSum[j] / n - fittedMean;
+                    if (residualVolatility) {
+                        residualVolatility[asset] = std::sqrt(residualSumSq / residualDegrees) * annualization;
+                    }
+                    if (rSquared) rSquared[asset] = totalSumSq > 0.0 ? 1.0 - residualSumSq / totalSumSq : 0.0;
+                }
+            }
+        });
+        
+        return 1;
+    }
+}
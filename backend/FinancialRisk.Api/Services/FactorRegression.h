@@ -0,0 +1,29 @@
+#ifndef FACTOR_REGRESSION_H
+#define FACTOR_REGRESSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Ordinary least squares of every asset on the same K factors, with intercept:
+//   r_asset(t) = alpha + sum_k beta_k * f_k(t) + e(t)
+//
+// factorReturns holds numFactors series and assetReturns numAssets series, each
+// numObservations long and stored one after another. The centered factor Gram
+// matrix is formed and Cholesky-factored once; the factor/asset cross products
+// for all assets come from one cache-blocked matrix multiply split across a
+// thread pool, followed by a K x K triangular solve per asset.
+//
+// betas receives numAssets x numFactors values (row per asset). alpha is per
+// period; residualVolatility is annualized like CalculateVolatility. Any output
+// may be null. Returns 0 (and zeroes the outputs) if numObservations <= numFactors
+// + 1 or the factors are collinear, 1 otherwise.
+int CalculateFactorExposures(double* assetReturns, double* factorReturns, int numObservations,
+                             int numAssets, int numFactors, double* alpha, double* betas,
+                             double* residualVolatility, double* rSquared);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FACTOR_REGRESSION_H
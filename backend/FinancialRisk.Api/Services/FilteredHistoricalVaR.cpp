@@ -0,0 +1,192 @@
+#include "FilteredHistoricalVaR.h"
+#include "VaRCalculations.h"
+#include "RandomStreams.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const int MinimumObservations = 20;
+    const double MaxPersistence = 0.9999;
+    const int DefaultScenarios = 10000;
+    // Paths handed to a worker at a time
+    const int PathGrain = 64;
+    
+    // Quasi log-likelihood of the residuals under variance targeting
+    double garchLogLikelihood(const double* residuals, int length, double variance, double alpha, double beta) {
+        const double omega = variance * (1.0 - alpha - beta);
+        double sigma2 = variance;
+        double logLikelihood = 0.0;
+        for (int t = 0; t < length; ++t) {
+            const double e2 = residuals[t] * residuals[t];
+            logLikelihood -= 0.5 * (std::log(sigma2) + e2 / sigma2);
+            sigma2 = omega + alpha * e2 + beta * sigma2;
+        }
+        return logLikelihood;
+    }
+    
+    bool feasible(double alpha, double persistence) {
+        return alpha >= 0.0 && alpha <= persistence && persistence <= MaxPersistence;
+    }
+    
+    // Fit GARCH(1,1) and write the standardized residuals (may be null). On
+    // failure the fit is the constant-variance model.
+    bool fitGarch(const double* returns, int length, GarchFit& fit, double* standardized) {
+        fit = GarchFit{0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        if (length < 2) return false;
+        
+        double mean = 0.0;
+        for (int t = 0; t < length; ++t) mean += returns[t];
+        mean /= length;
+        std::vector<double> residuals(length);
+        double variance = 0.0;
+        for (int t = 0; t < length; ++t) {
+            residuals[t] = returns[t] - mean;
+            variance += residuals[t] * residuals[t];
+        }
+        variance /= (length - 1);
+        fit.mean = mean;
+        fit.omega = variance;
+        fit.forecastVolatility = std::sqrt(variance);
+        
+        const bool fitted = length >= MinimumObservations && variance > 0.0;
+        if (fitted) {
+            // Coarse grid over (alpha, alpha + beta), then a shrinking compass search
+            double bestAlpha = 0.0, bestPersistence = 0.0;
+            double best = -std::numeric_limits<double>::infinity();
+            for (double alpha : {0.03, 0.06, 0.10, 0.15, 0.20}) {
+                for (double persistence : {0.85, 0.90, 0.95, 0.98, 0.995}) {
+                    double value = garchLogLikelihood(residuals.data(), length, variance, alpha, persistence - alpha);
+                    if (value > best) {
+                        best = value;
+                        bestAlpha = alpha;
+                        bestPersistence = persistence;
+                    }
+                }
+            }
+            double alphaStep = 0.02, persistenceStep = 0.01;
+            while (alphaStep > 1e-5) {
+                bool moved = false;
+                const double candidates[4][2] = {{alphaStep, 0.0}, {-alphaStep, 0.0},
+                                                 {0.0, persistenceStep}, {0.0, -persistenceStep}};
+                for (const auto& step : candidates) {
+                    double alpha = bestAlpha + step[0], persistence = bestPersistence + step[1];
+                    if (!feasible(alpha, persistence)) continue;
+                    double value = garchLogLikelihood(residuals.data(), length, variance, alpha, persistence - alpha);
+                    if (value > best) {
+                        best = value;
+                        bestAlpha = alpha;
+                        bestPersistence = persistence;
+                        moved = true;
+                    }
+                }
+                if (!moved) {
+                    alphaStep *= 0.5;
+                    persistenceStep *= 0.5;
+                }
+            }
+            fit.alpha = bestAlpha;
+            fit.beta = bestPersistence - bestAlpha;
+            fit.omega = variance * (1.0 - bestPersistence);
+            fit.logLikelihood = best;
+        }
+        
+        // Filter: standardized residuals and the one-day-ahead forecast
+        double sigma2 = variance;
+        for (int t = 0; t < length; ++t) {
+            if (standardized) standardized[t] = sigma2 > 0.0 ? residuals[t] / std::sqrt(sigma2) : 0.0;
+            sigma2 = fit.omega + fit.alpha * residuals[t] * residuals[t] + fit.beta * sigma2;
+        }
+        fit.forecastVolatility = std::sqrt(sigma2);
+        return fitted;
+    }
+}
+
+extern "C" {
+    // GARCH(1,1) quasi-maximum likelihood fit
+    int FitGARCH11(double* returns, int length, GarchFit* fit) {
+        if (returns == nullptr || fit == nullptr) return 0;
+        return fitGarch(returns, length, *fit, nullptr) ? 1 : 0;
+    }
+    
+    // One-day filtered historical simulation VaR/ES
+    void CalculateFilteredHistoricalVaR(double* returns, int length, double* confidenceLevels, int numLevels,
+                                        double* valueAtRisk, double* expectedShortfall, GarchFit* fit) {
+        if (returns == nullptr || confidenceLevels == nullptr || numLevels <= 0) return;
+        
+        GarchFit model;
+        std::vector<double> scenarios(std::max(length, 1), 0.0);
+        fitGarch(returns, length, model, scenarios.data());
+        for (int t = 0; t < length; ++t) {
+            scenarios[t] = model.mean + model.forecastVolatility * scenarios[t];
+        }
+        if (fit) *fit = model;
+        CalculateHistoricalVaRLevels(scenarios.data(), length, confidenceLevels, numLevels,
+                                     valueAtRisk, expectedShortfall);
+    }
+    
+    // Portfolio filtered historical simulation with joint residual resampling
+    void CalculatePortfolioFilteredHistoricalVaR(double* assetReturns, double* weights, int numAssets, int length,
+                                                 int horizon, int numScenarios, unsigned long long seed,
+                                                 double* confidenceLevels, int numLevels,
+                                                 double* valueAtRisk, double* expectedShortfall) {
+        if (assetReturns == nullptr || weights == nullptr || confidenceLevels == nullptr) return;
+        if (numAssets <= 0 || numLevels <= 0) return;
+        if (horizon < 1) horizon = 1;
+        if (numScenarios <= 0) numScenarios = DefaultScenarios;
+        
+        // One fit per asset; residuals stored date-major so a date's joint
+        // residual vector is contiguous
+        std::vector<GarchFit> fits(numAssets);
+        std::vector<double> residuals(static_cast<size_t>(std::max(length, 0)) * numAssets);
+        RiskKernels::parallelFor(numAssets, 1, [&](int begin, int end) {
+            std::vector<double> standardized(std::max(length, 0));
+            for (int a = begin; a < end; ++a) {
+                fitGarch(assetReturns + static_cast<size_t>(a) * length, length, fits[a], standardized.data());
+                for (int t = 0; t < length; ++t) {
+                    residuals[static_cast<size_t>(t) * numAssets + a] = standardized[t];
+                }
+            }
+        });
+        
+        // A series too short to fit still reaches the kernels, which report zeros
+        std::vector<double> pnl(1, 0.0);
+        if (horizon == 1 && length >= 1) {
+            pnl.assign(length, 0.0);
+            for (int t = 0; t < length; ++t) {
+                const double* z = residuals.data() + static_cast<size_t>(t) * numAssets;
+                for (int a = 0; a < numAssets; ++a) {
+                    pnl[t] += weights[a] * (fits[a].mean + fits[a].forecastVolatility * z[a]);
+                }
+            }
+        } else if (length >= 2) {
+            pnl.assign(numScenarios, 0.0);
+            RiskKernels::parallelFor(numScenarios, PathGrain, [&](int begin, int end) {
+                std::vector<double> variance(numAssets);
+                for (int s = begin; s < end; ++s) {
+                    RiskKernels::RandomStream stream(seed, static_cast<unsigned long long>(s));
+                    for (int a = 0; a < numAssets; ++a) {
+                        variance[a] = fits[a].forecastVolatility * fits[a].forecastVolatility;
+                    }
+                    double total = 0.0;
+                    for (int day = 0; day < horizon; ++day) {
+                        const int t = static_cast<int>(stream.nextIndex(static_cast<uint32_t>(length)));
+                        const double* z = residuals.data() + static_cast<size_t>(t) * numAssets;
+                        for (int a = 0; a < numAssets; ++a) {
+                            const GarchFit& model = fits[a];
+                            const double e = std::sqrt(variance[a]) * z[a];
+                            total += weights[a] * (model.mean + e);
+                            variance[a] = model.omega + model.alpha * e * e + model.beta * variance[a];
+                        }
+                    }
+                    pnl[s] = total;
+                }
+            });
+        }
+        
+        CalculateHistoricalVaRLevels(pnl.data(), static_cast<int>(pnl.size()), confidenceLevels, numLevels,
+                                     valueAtRisk, expectedShortfall);
+    }
+}
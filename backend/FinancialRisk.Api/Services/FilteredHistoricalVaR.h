@@ -0,0 +1,59 @@
+#ifndef FILTERED_HISTORICAL_VAR_H
+#define FILTERED_HISTORICAL_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// GARCH(1,1) fit of one return series:
+//   r_t = mean + e_t,  e_t = sigma_t z_t,
+//   sigma_t^2 = omega + alpha e_{t-1}^2 + beta sigma_{t-1}^2
+typedef struct GarchFit {
+    double mean;
+    double omega;
+    double alpha;
+    double beta;
+    double forecastVolatility;  // sigma for the day after the last return
+    double logLikelihood;       // Gaussian quasi log-likelihood, constants dropped
+} GarchFit;
+
+// Fit GARCH(1,1) by Gaussian quasi-maximum likelihood with variance targeting
+// (omega = sample variance x (1 - alpha - beta)): a coarse grid over alpha and
+// alpha + beta, refined by a shrinking compass search. The recursion is the
+// one GARCHDistribution in MonteCarloEngine.cpp simulates, started from the
+// sample variance. Returns 0 if length < 20 or the series is constant; fit then
+// holds the sample mean and variance with alpha = beta = 0.
+int FitGARCH11(double* returns, int length, GarchFit* fit);
+
+// One-day filtered historical simulation VaR and ES of one series: the
+// standardized residuals z_t are rescaled by the forecast volatility, and
+// mean + forecastVolatility * z_t goes through the historical VaR/ES kernels
+// (as CalculateHistoricalVaRLevels). Levels outside (0, 1) report 0. Any
+// output may be null.
+void CalculateFilteredHistoricalVaR(double* returns, int length, double* confidenceLevels, int numLevels,
+                                    double* valueAtRisk, double* expectedShortfall, GarchFit* fit);
+
+// Filtered historical simulation for a portfolio. assetReturns holds numAssets
+// aligned series of length observations, one after another; every asset gets
+// its own GARCH(1,1) fit (in parallel). Scenarios resample whole dates, so the
+// joint residual vector z_t of all assets is kept together and the
+// cross-sectional dependence survives the filtering. Over a horizon of several
+// days each asset's variance is updated with the GARCH recursion along the
+// path, and the horizon P&L is the weighted sum of the simple daily returns.
+//
+// horizon = 1 uses every date once (no sampling, numScenarios and seed are
+// ignored). horizon > 1 simulates numScenarios paths (10000 if numScenarios <=
+// 0) split across a thread pool; path s draws from its own random stream keyed
+// by (seed, s), so results do not depend on the thread count. VaR/ES follow
+// the historical kernels applied to the scenario P&L. Levels outside (0, 1)
+// report 0; either output may be null.
+void CalculatePortfolioFilteredHistoricalVaR(double* assetReturns, double* weights, int numAssets, int length,
+                                             int horizon, int numScenarios, unsigned long long seed,
+                                             double* confidenceLevels, int numLevels,
+                                             double* valueAtRisk, double* expectedShortfall);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FILTERED_HISTORICAL_VAR_H
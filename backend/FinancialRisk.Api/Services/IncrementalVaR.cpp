@@ -0,0 +1,170 @@
+#include "IncrementalVaR.h"
+#include "QuantileKernels.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // Ranks kept on each side of the VaR/ES order statistics, at least
+    // MinimumReach or 2% of the scenarios
+    const int MinimumReach = 32;
+    // Candidates handed to a worker at a time
+    const int CandidateGrain = 4;
+    
+    // VaR order statistic and ES tail of values[0, length) after nested
+    // selection, offset by below values (summing to belowSum) known to be smaller
+    void selectFromBand(double* values, int length, int index, int tailCount, int below, double belowSum,
+                        double& valueAtRisk, double& expectedShortfall) {
+        const int bandIndex = index - below;
+        const int bandTail = tailCount - below;
+        const int deeper = std::max(bandIndex, bandTail - 1);
+        const int shallower = std::min(bandIndex, bandTail - 1);
+        std::nth_element(values, values + deeper, values + length);
+        if (shallower < deeper) {
+            std::nth_element(values, values + shallower, values + deeper);
+        }
+        double tailSum = belowSum;
+        for (int i = 0; i < bandTail; ++i) tailSum += values[i];
+        valueAtRisk = -values[bandIndex];
+        expectedShortfall = -(tailSum / tailCount);
+    }
+}
+
+struct IncrementalVaREngine {
+    std::vector<double> pnl;
+    int index;
+    int tailCount;
+    int reach;
+    double valueAtRisk = 0.0;
+    double expectedShortfall = 0.0;
+    
+    // Scenarios at ranks [windowStart, windowStart + window.size()) of the
+    // current P&L, in rank order; candidate pivots are read from here
+    std::vector<int> window;
+    int windowStart = 0;
+    
+    IncrementalVaREngine(const double* values, int length, double confidenceLevel)
+        : pnl(values, values + length),
+          index(RiskKernels::historicalVaRIndex(confidenceLevel, length)),
+          tailCount(RiskKernels::historicalTailCount(confidenceLevel, length)),
+          reach(std::max(MinimumReach, length / 50)) {
+        rank();
+    }
+    
+    int length() const { return static_cast<int>(pnl.size()); }
+    int lowestNeeded() const { return std::min(index, tailCount - 1); }
+    int highestNeeded() const { return std::max(index, tailCount - 1); }
+    
+    // Rank the scenarios around the VaR/ES order statistics and refresh VaR/ES
+    void rank() {
+        const int n = length();
+        std::vector<int> order(n);
+        for (int t = 0; t < n; ++t) order[t] = t;
+        auto lower = [&](int a, int b) { return pnl[a] < pnl[b] || (pnl[a] == pnl[b] && a < b); };
+        
+        windowStart = std::max(0, lowestNeeded() - reach);
+        const int windowEnd = std::min(n - 1, highestNeeded() + reach);
+        std::nth_element(order.begin(), order.begin() + windowStart, order.end(), lower);
+        if (windowEnd > windowStart) {
+            std::nth_element(order.begin() + windowStart + 1, order.begin() + windowEnd, order.end(), lower);
+        }
+        std::sort(order.begin() + windowStart, order.begin() + windowEnd + 1, lower);
+        window.assign(order.begin() + windowStart, order.begin() + windowEnd + 1);
+        
+        double tailSum = 0.0;
+        for (int r = 0; r < tailCount; ++r) tailSum += pnl[order[r]];
+        valueAtRisk = -pnl[order[index]];
+        expectedShortfall = -(tailSum / tailCount);
+    }
+    
+    // VaR and ES of a modified P&L vector (reordered in place). Pivots are the
+    // new values of the scenarios currently ranked offset places either side of
+    // the needed order statistics: if the count below the lower pivot and the
+    // band between the pivots still bracket them, only the band is selected.
+    void evaluate(double* values, std::vector<double>& band, double& var, double& es) const {
+        const int n = length();
+        const double infinity = std::numeric_limits<double>::infinity();
+        for (int offset : {std::max(1, reach / 4), reach}) {
+            const int lowRank = lowestNeeded() - offset;
+            const int highRank = highestNeeded() + offset;
+            const double lo = lowRank <= 0 ? -infinity : values[window[lowRank - windowStart]];
+            const double hi = highRank >= n - 1 ? infinity : values[window[highRank - windowStart]];
+            if (!(lo <= hi)) continue;
+            
+            band.clear();
+            int below = 0;
+            double belowSum = 0.0;
+            for (int t = 0; t < n; ++t) {
+                const double value = values[t];
+                if (value < lo) {
+                    ++below;
+                    belowSum += value;
+                } else if (value <= hi) {
+                    band.push_back(value);
+                }
+            }
+            if (below <= lowestNeeded() && below + static_cast<int>(band.size()) > highestNeeded()) {
+                selectFromBand(band.data(), static_cast<int>(band.size()), index, tailCount, below, belowSum, var, es);
+                return;
+            }
+        }
+        selectFromBand(values, n, index, tailCount, 0, 0.0, var, es);
+    }
+};
+
+extern "C" {
+    // Create a what-if VaR engine
+    IncrementalVaREngine* CreateIncrementalVaREngine(double* scenarioPnL, int numScenarios, double confidenceLevel) {
+        if (scenarioPnL == nullptr || numScenarios < 2) return nullptr;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return nullptr;
+        return new IncrementalVaREngine(scenarioPnL, numScenarios, confidenceLevel);
+    }
+    
+    // Destroy a what-if VaR engine
+    void DestroyIncrementalVaREngine(IncrementalVaREngine* engine) {
+        delete engine;
+    }
+    
+    // Book a position into the engine's portfolio
+    void AddIncrementalVaRPosition(IncrementalVaREngine* engine, double* positionPnL, double size) {
+        if (engine == nullptr || positionPnL == nullptr) return;
+        for (int t = 0; t < engine->length(); ++t) {
+            engine->pnl[t] += size * positionPnL[t];
+        }
+        engine->rank();
+    }
+    
+    // Current VaR/ES
+    void QueryIncrementalVaR(IncrementalVaREngine* engine, double* valueAtRisk, double* expectedShortfall) {
+        if (engine == nullptr) return;
+        if (valueAtRisk) *valueAtRisk = engine->valueAtRisk;
+        if (expectedShortfall) *expectedShortfall = engine->expectedShortfall;
+    }
+    
+    // VaR/ES after each candidate trade
+    void EvaluateIncrementalVaR(IncrementalVaREngine* engine, double* candidatePnL, double* sizes, int numCandidates,
+                                double* newVaR, double* newES, double* deltaVaR, double* deltaES) {
+        if (engine == nullptr || candidatePnL == nullptr || sizes == nullptr || numCandidates <= 0) return;
+        const int n = engine->length();
+        
+        RiskKernels::parallelFor(numCandidates, CandidateGrain, [&](int begin, int end) {
+            thread_local std::vector<double> values, band;
+            values.resize(n);
+            for (int c = begin; c < end; ++c) {
+                const double* position = candidatePnL + static_cast<size_t>(c) * n;
+                const double size = sizes[c];
+                for (int t = 0; t < n; ++t) {
+                    values[t] = engine->pnl[t] + size * position[t];
+                }
+                
+                double var = 0.0, es = 0.0;
+                engine->evaluate(values.data(), band, var, es);
+                if (newVaR) newVaR[c] = var;
+                if (newES) newES[c] = es;
+                if (deltaVaR) deltaVaR[c] = var - engine->valueAtRisk;
+                if (deltaES) deltaES[c] = es - engine->expectedShortfall;
+            }
+        });
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef INCREMENTAL_VAR_H
+#define INCREMENTAL_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Opaque what-if engine. It owns a copy of a portfolio's scenario P&L vector,
+// its historical VaR and ES, and the scenarios ranked around the VaR order
+// statistic. Candidate trades are priced against it without rebuilding the
+// portfolio series.
+typedef struct IncrementalVaREngine IncrementalVaREngine;
+
+// Create an engine from numScenarios portfolio P&L values. VaR and ES follow
+// CalculateHistoricalVaR / CalculateHistoricalCVaR at confidenceLevel. Returns
+// null if numScenarios < 2 or confidenceLevel is outside (0, 1).
+IncrementalVaREngine* CreateIncrementalVaREngine(double* scenarioPnL, int numScenarios, double confidenceLevel);
+
+// Release an engine created by CreateIncrementalVaREngine
+void DestroyIncrementalVaREngine(IncrementalVaREngine* engine);
+
+// Book a trade into the portfolio: pnl += size * positionPnL, then re-rank
+void AddIncrementalVaRPosition(IncrementalVaREngine* engine, double* positionPnL, double size);
+
+// Current portfolio VaR and ES. Either output may be null.
+void QueryIncrementalVaR(IncrementalVaREngine* engine, double* valueAtRisk, double* expectedShortfall);
+
+// Price numCandidates candidate trades without booking them. candidatePnL
+// holds numCandidates scenario vectors, one after another, and candidate i adds
+// sizes[i] * its vector to the portfolio. Each candidate costs one O(n) pass:
+// the new P&L is bracketed by pivots taken from the current ranking around the
+// VaR scenario, and only the values inside the bracket are selected; if a
+// trade moves the quantile outside the bracket, a full selection is the
+// fallback. Candidates are split across a thread pool. Any output may be null.
+void EvaluateIncrementalVaR(IncrementalVaREngine* engine, double* candidatePnL, double* sizes, int numCandidates,
+                            double* newVaR, double* newES, double* deltaVaR, double* deltaES);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INCREMENTAL_VAR_H
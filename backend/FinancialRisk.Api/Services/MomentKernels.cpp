@@ -0,0 +1,156 @@
+#include "MomentKernels.h"
+#include <atomic>
+
+#if defined(RISK_KERNELS_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace RiskKernels {
+
+    namespace {
+        // Scalar kernels: the original single-accumulator loops, kept as the
+        // fallback and as the reference the vector kernels are tested against
+        double scalarSum(const double* x, int length) {
+            double sum = 0.0;
+            for (int i = 0; i < length; ++i) {
+                sum += x[i];
+            }
+            return sum;
+        }
+
+        double scalarSumSquaredDeviations(const double* x, int length, double mean) {
+            double sum = 0.0;
+            for (int i = 0; i < length; ++i) {
+                double diff = x[i] - mean;
+                sum += diff * diff;
+            }
+            return sum;
+        }
+
+        void scalarSumPair(const double* x, const double* y, int length, double* sumX, double* sumY) {
+            double sx = 0.0, sy = 0.0;
+            for (int i = 0; i < length; ++i) {
+                sx += x[i];
+                sy += y[i];
+            }
+            *sumX = sx;
+            *sumY = sy;
+        }
+
+        void scalarCoMoments(const double* x, const double* y, int length, double meanX, double meanY,
+                             double* crossSum, double* sumSquaresY) {
+            double sxy = 0.0, syy = 0.0;
+            for (int i = 0; i < length; ++i) {
+                double diffX = x[i] - meanX;
+                double diffY = y[i] - meanY;
+                sxy += diffX * diffY;
+                syy += diffY * diffY;
+            }
+            *crossSum = sxy;
+            *sumSquaresY = syy;
+        }
+
+        double scalarSumDifference(const double* x, const double* y, int length) {
+            double sum = 0.0;
+            for (int i = 0; i < length; ++i) {
+                sum += (x[i] - y[i]);
+            }
+            return sum;
+        }
+
+        double scalarSumSquaredDifferenceDeviations(const double* x, const double* y, int length, double mean) {
+            double sum = 0.0;
+            for (int i = 0; i < length; ++i) {
+                double diff = (x[i] - y[i]) - mean;
+                sum += diff * diff;
+            }
+            return sum;
+        }
+
+#if defined(RISK_KERNELS_X86)
+        bool cpuSupportsAVX2() {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool fma = (info[2] & (1 << 12)) != 0;
+            if (!osxsave || !fma) return false;
+            if ((_xgetbv(0) & 0x6) != 0x6) return false; // XMM and YMM state enabled by the OS
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        }
+
+        bool cpuSupportsAVX512() {
+#if defined(_MSC_VER)
+            if (!cpuSupportsAVX2()) return false;
+            if ((_xgetbv(0) & 0xE6) != 0xE6) return false; // opmask and ZMM state enabled by the OS
+            int info[4];
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 16)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        }
+#endif
+
+        MomentKernelIsa bestSupportedIsa() {
+#if defined(RISK_KERNELS_X86)
+            if (cpuSupportsAVX512()) return IsaAVX512;
+            if (cpuSupportsAVX2()) return IsaAVX2;
+#endif
+            return IsaScalar;
+        }
+
+        const MomentKernels& kernelsFor(MomentKernelIsa isa) {
+#if defined(RISK_KERNELS_X86)
+            if (isa == IsaAVX512) return avx512MomentKernels;
+            if (isa == IsaAVX2) return avx2MomentKernels;
+#endif
+            return scalarMomentKernels;
+        }
+
+        // Resolved once when the library is loaded
+        std::atomic<MomentKernelIsa> activeIsa{bestSupportedIsa()};
+    }
+
+    const MomentKernels scalarMomentKernels = {
+        scalarSum,
+        scalarSumSquaredDeviations,
+        scalarSumPair,
+        scalarCoMoments,
+        scalarSumDifference,
+        scalarSumSquaredDifferenceDeviations
+    };
+
+    bool isMomentKernelIsaSupported(MomentKernelIsa isa) {
+        switch (isa) {
+            case IsaScalar: return true;
+#if defined(RISK_KERNELS_X86)
+            case IsaAVX2: return cpuSupportsAVX2();
+            case IsaAVX512: return cpuSupportsAVX512();
+#endif
+            default: return false;
+        }
+    }
+
+    const MomentKernels& activeMomentKernels() {
+        return kernelsFor(activeIsa.load(std::memory_order_relaxed));
+    }
+
+    MomentKernelIsa activeMomentKernelIsa() {
+        return activeIsa.load(std::memory_order_relaxed);
+    }
+
+    MomentKernelIsa selectMomentKernels(MomentKernelIsa isa) {
+        if (isMomentKernelIsaSupported(isa)) {
+            activeIsa.store(isa, std::memory_order_relaxed);
+        }
+        return activeMomentKernelIsa();
+    }
+}
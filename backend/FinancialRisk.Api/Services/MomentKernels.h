@@ -0,0 +1,48 @@
+#ifndef MOMENT_KERNELS_H
+#define MOMENT_KERNELS_H
+
+// Internal reduction kernels behind CalculateVolatility, CalculateBeta and
+// CalculateInformationRatio. Each instruction set provides the same table;
+// the best one supported by the CPU is picked when the library is loaded.
+namespace RiskKernels {
+
+    enum MomentKernelIsa {
+        IsaScalar = 0,
+        IsaAVX2 = 1,
+        IsaAVX512 = 2
+    };
+
+    struct MomentKernels {
+        // sum(x)
+        double (*sum)(const double* x, int length);
+        // sum((x - mean)^2)
+        double (*sumSquaredDeviations)(const double* x, int length, double mean);
+        // sum(x), sum(y)
+        void (*sumPair)(const double* x, const double* y, int length, double* sumX, double* sumY);
+        // sum((x - meanX) * (y - meanY)), sum((y - meanY)^2)
+        void (*coMoments)(const double* x, const double* y, int length, double meanX, double meanY,
+                          double* crossSum, double* sumSquaresY);
+        // sum(x - y)
+        double (*sumDifference)(const double* x, const double* y, int length);
+        // sum(((x - y) - mean)^2)
+        double (*sumSquaredDifferenceDeviations)(const double* x, const double* y, int length, double mean);
+    };
+
+    // Scalar reference implementation, always available
+    extern const MomentKernels scalarMomentKernels;
+
+#if defined(RISK_KERNELS_X86)
+    extern const MomentKernels avx2MomentKernels;
+    extern const MomentKernels avx512MomentKernels;
+#endif
+
+    // Kernels selected for this process (defaults to the best supported ISA)
+    const MomentKernels& activeMomentKernels();
+    MomentKernelIsa activeMomentKernelIsa();
+
+    // Switch to the given ISA if the CPU supports it; returns the ISA in use
+    MomentKernelIsa selectMomentKernels(MomentKernelIsa isa);
+    bool isMomentKernelIsaSupported(MomentKernelIsa isa);
+}
+
+#endif // MOMENT_KERNELS_H
@@ -0,0 +1,165 @@
+// AVX2/FMA moment kernels. This file is compiled with AVX2 code generation
+// enabled, so it must only be reached through the runtime dispatch in
+// MomentKernels.cpp and must not include headers with inline library code.
+#include "MomentKernels.h"
+#include <immintrin.h>
+
+namespace RiskKernels {
+
+    namespace {
+        inline double horizontalSum(__m256d v) {
+            __m128d low = _mm256_castpd256_pd128(v);
+            __m128d high = _mm256_extractf128_pd(v, 1);
+            low = _mm_add_pd(low, high);
+            __m128d swapped = _mm_unpackhi_pd(low, low);
+            return _mm_cvtsd_f64(_mm_add_sd(low, swapped));
+        }
+
+        // Four independent accumulators (16 doubles per iteration) break the
+        // loop-carried dependency of the scalar reference loops
+        double avx2Sum(const double* x, int length) {
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= length; i += 16) {
+                acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+                acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x + i + 4));
+                acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(x + i + 8));
+                acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(x + i + 12));
+            }
+            for (; i + 4 <= length; i += 4) {
+                acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x + i));
+            }
+            double sum = horizontalSum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+            for (; i < length; ++i) {
+                sum += x[i];
+            }
+            return sum;
+        }
+
+        double avx2SumSquaredDeviations(const double* x, int length, double mean) {
+            const __m256d m = _mm256_set1_pd(mean);
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), m);
+                __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), m);
+                __m256d d2 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 8), m);
+                __m256d d3 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 12), m);
+                acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+                acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+                acc2 = _mm256_fmadd_pd(d2, d2, acc2);
+                acc3 = _mm256_fmadd_pd(d3, d3, acc3);
+            }
+            for (; i + 4 <= length; i += 4) {
+                __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), m);
+                acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+            }
+            double sum = horizontalSum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+            for (; i < length; ++i) {
+                double diff = x[i] - mean;
+                sum += diff * diff;
+            }
+            return sum;
+        }
+
+        void avx2SumPair(const double* x, const double* y, int length, double* sumX, double* sumY) {
+            __m256d accX0 = _mm256_setzero_pd(), accX1 = _mm256_setzero_pd();
+            __m256d accY0 = _mm256_setzero_pd(), accY1 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 8 <= length; i += 8) {
+                accX0 = _mm256_add_pd(accX0, _mm256_loadu_pd(x + i));
+                accX1 = _mm256_add_pd(accX1, _mm256_loadu_pd(x + i + 4));
+                accY0 = _mm256_add_pd(accY0, _mm256_loadu_pd(y + i));
+                accY1 = _mm256_add_pd(accY1, _mm256_loadu_pd(y + i + 4));
+            }
+            double sx = horizontalSum(_mm256_add_pd(accX0, accX1));
+            double sy = horizontalSum(_mm256_add_pd(accY0, accY1));
+            for (; i < length; ++i) {
+                sx += x[i];
+                sy += y[i];
+            }
+            *sumX = sx;
+            *sumY = sy;
+        }
+
+        void avx2CoMoments(const double* x, const double* y, int length, double meanX, double meanY,
+                           double* crossSum, double* sumSquaresY) {
+            const __m256d mx = _mm256_set1_pd(meanX);
+            const __m256d my = _mm256_set1_pd(meanY);
+            __m256d accXY0 = _mm256_setzero_pd(), accXY1 = _mm256_setzero_pd();
+            __m256d accYY0 = _mm256_setzero_pd(), accYY1 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 8 <= length; i += 8) {
+                __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), mx);
+                __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), mx);
+                __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(y + i), my);
+                __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(y + i + 4), my);
+                accXY0 = _mm256_fmadd_pd(dx0, dy0, accXY0);
+                accXY1 = _mm256_fmadd_pd(dx1, dy1, accXY1);
+                accYY0 = _mm256_fmadd_pd(dy0, dy0, accYY0);
+                accYY1 = _mm256_fmadd_pd(dy1, dy1, accYY1);
+            }
+            double sxy = horizontalSum(_mm256_add_pd(accXY0, accXY1));
+            double syy = horizontalSum(_mm256_add_pd(accYY0, accYY1));
+            for (; i < length; ++i) {
+                double diffX = x[i] - meanX;
+                double diffY = y[i] - meanY;
+                sxy += diffX * diffY;
+                syy += diffY * diffY;
+            }
+            *crossSum = sxy;
+            *sumSquaresY = syy;
+        }
+
+        double avx2SumDifference(const double* x, const double* y, int length) {
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= length; i += 16) {
+                acc0 = _mm256_add_pd(acc0, _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+                acc1 = _mm256_add_pd(acc1, _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+                acc2 = _mm256_add_pd(acc2, _mm256_sub_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8)));
+                acc3 = _mm256_add_pd(acc3, _mm256_sub_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12)));
+            }
+            double sum = horizontalSum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+            for (; i < length; ++i) {
+                sum += (x[i] - y[i]);
+            }
+            return sum;
+        }
+
+        double avx2SumSquaredDifferenceDeviations(const double* x, const double* y, int length, double mean) {
+            const __m256d m = _mm256_set1_pd(mean);
+            __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+            __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m256d d0 = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)), m);
+                __m256d d1 = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)), m);
+                __m256d d2 = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8)), m);
+                __m256d d3 = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12)), m);
+                acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+                acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+                acc2 = _mm256_fmadd_pd(d2, d2, acc2);
+                acc3 = _mm256_fmadd_pd(d3, d3, acc3);
+            }
+            double sum = horizontalSum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+            for (; i < length; ++i) {
+                double diff = (x[i] - y[i]) - mean;
+                sum += diff * diff;
+            }
+            return sum;
+        }
+    }
+
+    const MomentKernels avx2MomentKernels = {
+        avx2Sum,
+        avx2SumSquaredDeviations,
+        avx2SumPair,
+        avx2CoMoments,
+        avx2SumDifference,
+        avx2SumSquaredDifferenceDeviations
+    };
+}
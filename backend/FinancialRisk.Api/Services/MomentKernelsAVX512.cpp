@@ -0,0 +1,172 @@
+// AVX-512F moment kernels. This file is compiled with AVX-512 code generation
+// enabled, so it must only be reached through the runtime dispatch in
+// MomentKernels.cpp and must not include headers with inline library code.
+#include "MomentKernels.h"
+#include <immintrin.h>
+
+namespace RiskKernels {
+
+    namespace {
+        // Lanes [0, remaining) of the final partial vector; masked-off lanes load as 0
+        inline __mmask8 tailMask(int remaining) {
+            return static_cast<__mmask8>((1u << remaining) - 1u);
+        }
+
+        // Explicit reduction; _mm512_reduce_add_pd and the unmasked extracts
+        // trip -Wuninitialized in GCC 12's headers, the merge-masked forms do not
+        inline double horizontalSum(__m512d v) {
+            const __m256d zero = _mm256_setzero_pd();
+            const __mmask8 all = static_cast<__mmask8>(0x0F);
+            __m256d half = _mm256_add_pd(_mm512_mask_extractf64x4_pd(zero, all, v, 0),
+                                         _mm512_mask_extractf64x4_pd(zero, all, v, 1));
+            __m128d quarter = _mm_add_pd(_mm256_castpd256_pd128(half), _mm256_extractf128_pd(half, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(quarter, _mm_unpackhi_pd(quarter, quarter)));
+        }
+
+        // Four independent accumulators (32 doubles per iteration), with the
+        // remainder handled by one masked iteration instead of a scalar loop
+        double avx512Sum(const double* x, int length) {
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 32 <= length; i += 32) {
+                acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(x + i));
+                acc1 = _mm512_add_pd(acc1, _mm512_loadu_pd(x + i + 8));
+                acc2 = _mm512_add_pd(acc2, _mm512_loadu_pd(x + i + 16));
+                acc3 = _mm512_add_pd(acc3, _mm512_loadu_pd(x + i + 24));
+            }
+            for (; i + 8 <= length; i += 8) {
+                acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(x + i));
+            }
+            if (i < length) {
+                acc1 = _mm512_add_pd(acc1, _mm512_maskz_loadu_pd(tailMask(length - i), x + i));
+            }
+            return horizontalSum(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+        }
+
+        double avx512SumSquaredDeviations(const double* x, int length, double mean) {
+            const __m512d m = _mm512_set1_pd(mean);
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 32 <= length; i += 32) {
+                __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), m);
+                __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), m);
+                __m512d d2 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 16), m);
+                __m512d d3 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 24), m);
+                acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+                acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+                acc2 = _mm512_fmadd_pd(d2, d2, acc2);
+                acc3 = _mm512_fmadd_pd(d3, d3, acc3);
+            }
+            for (; i + 8 <= length; i += 8) {
+                __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), m);
+                acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+            }
+            if (i < length) {
+                __mmask8 mask = tailMask(length - i);
+                __m512d d1 = _mm512_maskz_sub_pd(mask, _mm512_maskz_loadu_pd(mask, x + i), m);
+                acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+            }
+            return horizontalSum(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+        }
+
+        void avx512SumPair(const double* x, const double* y, int length, double* sumX, double* sumY) {
+            __m512d accX0 = _mm512_setzero_pd(), accX1 = _mm512_setzero_pd();
+            __m512d accY0 = _mm512_setzero_pd(), accY1 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= length; i += 16) {
+                accX0 = _mm512_add_pd(accX0, _mm512_loadu_pd(x + i));
+                accX1 = _mm512_add_pd(accX1, _mm512_loadu_pd(x + i + 8));
+                accY0 = _mm512_add_pd(accY0, _mm512_loadu_pd(y + i));
+                accY1 = _mm512_add_pd(accY1, _mm512_loadu_pd(y + i + 8));
+            }
+            for (; i < length; i += 8) {
+                __mmask8 mask = length - i >= 8 ? static_cast<__mmask8>(0xFF) : tailMask(length - i);
+                accX0 = _mm512_add_pd(accX0, _mm512_maskz_loadu_pd(mask, x + i));
+                accY0 = _mm512_add_pd(accY0, _mm512_maskz_loadu_pd(mask, y + i));
+            }
+            *sumX = horizontalSum(_mm512_add_pd(accX0, accX1));
+            *sumY = horizontalSum(_mm512_add_pd(accY0, accY1));
+        }
+
+        void avx512CoMoments(const double* x, const double* y, int length, double meanX, double meanY,
+                             double* crossSum, double* sumSquaresY) {
+            const __m512d mx = _mm512_set1_pd(meanX);
+            const __m512d my = _mm512_set1_pd(meanY);
+            __m512d accXY0 = _mm512_setzero_pd(), accXY1 = _mm512_setzero_pd();
+            __m512d accYY0 = _mm512_setzero_pd(), accYY1 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m512d dx0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), mx);
+                __m512d dx1 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), mx);
+                __m512d dy0 = _mm512_sub_pd(_mm512_loadu_pd(y + i), my);
+                __m512d dy1 = _mm512_sub_pd(_mm512_loadu_pd(y + i + 8), my);
+                accXY0 = _mm512_fmadd_pd(dx0, dy0, accXY0);
+                accXY1 = _mm512_fmadd_pd(dx1, dy1, accXY1);
+                accYY0 = _mm512_fmadd_pd(dy0, dy0, accYY0);
+                accYY1 = _mm512_fmadd_pd(dy1, dy1, accYY1);
+            }
+            for (; i < length; i += 8) {
+                __mmask8 mask = length - i >= 8 ? static_cast<__mmask8>(0xFF) : tailMask(length - i);
+                __m512d dx = _mm512_maskz_sub_pd(mask, _mm512_maskz_loadu_pd(mask, x + i), mx);
+                __m512d dy = _mm512_maskz_sub_pd(mask, _mm512_maskz_loadu_pd(mask, y + i), my);
+                accXY0 = _mm512_fmadd_pd(dx, dy, accXY0);
+                accYY0 = _mm512_fmadd_pd(dy, dy, accYY0);
+            }
+            *crossSum = horizontalSum(_mm512_add_pd(accXY0, accXY1));
+            *sumSquaresY = horizontalSum(_mm512_add_pd(accYY0, accYY1));
+        }
+
+        double avx512SumDifference(const double* x, const double* y, int length) {
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 32 <= length; i += 32) {
+                acc0 = _mm512_add_pd(acc0, _mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+                acc1 = _mm512_add_pd(acc1, _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8)));
+                acc2 = _mm512_add_pd(acc2, _mm512_sub_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16)));
+                acc3 = _mm512_add_pd(acc3, _mm512_sub_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24)));
+            }
+            for (; i < length; i += 8) {
+                __mmask8 mask = length - i >= 8 ? static_cast<__mmask8>(0xFF) : tailMask(length - i);
+                acc0 = _mm512_add_pd(acc0, _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i),
+                                                         _mm512_maskz_loadu_pd(mask, y + i)));
+            }
+            return horizontalSum(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+        }
+
+        double avx512SumSquaredDifferenceDeviations(const double* x, const double* y, int length, double mean) {
+            const __m512d m = _mm512_set1_pd(mean);
+            __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+            __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+            int i = 0;
+            for (; i + 32 <= length; i += 32) {
+                __m512d d0 = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)), m);
+                __m512d d1 = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8)), m);
+                __m512d d2 = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16)), m);
+                __m512d d3 = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24)), m);
+                acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+                acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+                acc2 = _mm512_fmadd_pd(d2, d2, acc2);
+                acc3 = _mm512_fmadd_pd(d3, d3, acc3);
+            }
+            for (; i < length; i += 8) {
+                __mmask8 mask = length - i >= 8 ? static_cast<__mmask8>(0xFF) : tailMask(length - i);
+                __m512d diff = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+                __m512d d = _mm512_maskz_sub_pd(mask, diff, m);
+                acc0 = _mm512_fmadd_pd(d, d, acc0);
+            }
+            return horizontalSum(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+        }
+    }
+
+    const MomentKernels avx512MomentKernels = {
+        avx512Sum,
+        avx512SumSquaredDeviations,
+        avx512SumPair,
+        avx512CoMoments,
+        avx512SumDifference,
+        avx512SumSquaredDifferenceDeviations
+    };
+}
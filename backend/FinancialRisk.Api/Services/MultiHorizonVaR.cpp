@@ -0,0 +1,63 @@
+#include "MultiHorizonVaR.h"
+#include "QuantileKernels.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+    // Historical VaR/ES of overlapping h-day returns for several horizons
+    void CalculateMultiHorizonVaR(double* returns, int length, int* horizons, int numHorizons,
+                                  double* confidenceLevels, int numLevels, int compounding,
+                                  double* valueAtRisk, double* expectedShortfall) {
+        if (returns == nullptr || horizons == nullptr || confidenceLevels == nullptr) return;
+        if (numHorizons <= 0 || numLevels <= 0) return;
+        const size_t total = static_cast<size_t>(numHorizons) * numLevels;
+        if (valueAtRisk) std::fill(valueAtRisk, valueAtRisk + total, 0.0);
+        if (expectedShortfall) std::fill(expectedShortfall, expectedShortfall + total, 0.0);
+        if (length < 2) return;
+        if (compounding != HORIZON_ADDITIVE && compounding != HORIZON_COMPOUNDED) return;
+        
+        std::vector<double> levels;
+        std::vector<int> positions;
+        for (int level = 0; level < numLevels; ++level) {
+            if (confidenceLevels[level] > 0.0 && confidenceLevels[level] < 1.0) {
+                levels.push_back(confidenceLevels[level]);
+                positions.push_back(level);
+            }
+        }
+        if (levels.empty()) return;
+        const int valid = static_cast<int>(levels.size());
+        
+        // prefix[t] = sum of the first t daily terms
+        const bool compounded = compounding == HORIZON_COMPOUNDED;
+        std::vector<double> prefix(length + 1, 0.0);
+        for (int t = 0; t < length; ++t) {
+            prefix[t + 1] = prefix[t] + (compounded ? std::log1p(returns[t]) : returns[t]);
+        }
+        
+        // One selection buffer for every horizon; the longest window set is length
+        std::vector<double> work(length);
+        std::vector<double> var(valid), es(valid);
+        for (int k = 0; k < numHorizons; ++k) {
+            const int horizon = horizons[k];
+            const int windows = length - horizon + 1;
+            if (horizon < 1 || windows < 2) continue;
+            
+            if (horizon == 1) {
+                std::copy(returns, returns + length, work.begin());
+            } else if (compounded) {
+                for (int t = 0; t < windows; ++t) work[t] = std::expm1(prefix[t + horizon] - prefix[t]);
+            } else {
+                for (int t = 0; t < windows; ++t) work[t] = prefix[t + horizon] - prefix[t];
+            }
+            
+            int maxTail = RiskKernels::selectVaRLevels(work.data(), windows, levels.data(), valid, var.data());
+            RiskKernels::tailAveragesOfLevels(work.data(), windows, levels.data(), valid, maxTail, es.data());
+            const size_t row = static_cast<size_t>(k) * numLevels;
+            for (int l = 0; l < valid; ++l) {
+                if (valueAtRisk) valueAtRisk[row + positions[l]] = var[l];
+                if (expectedShortfall) expectedShortfall[row + positions[l]] = es[l];
+            }
+        }
+    }
+}
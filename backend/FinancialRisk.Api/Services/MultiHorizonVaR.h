@@ -0,0 +1,34 @@
+#ifndef MULTI_HORIZON_VAR_H
+#define MULTI_HORIZON_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// How h-day returns are formed from daily returns
+#define HORIZON_ADDITIVE 0    // sum of the daily returns (log returns)
+#define HORIZON_COMPOUNDED 1  // product of (1 + r) minus 1 (simple returns, each > -1)
+
+// Historical VaR and ES over several horizons at once.
+//
+// For each horizon h the overlapping h-day returns of the series (windows
+// starting at t = 0 .. length - h) are read off one prefix-sum array as
+// differences, so building every horizon costs O(length) and no cumulative
+// sums are repeated; compounded mode sums log(1 + r) and converts back with
+// expm1. Each horizon's returns are written into one scratch buffer shared by
+// all horizons and go through the historical VaR/ES kernels (as
+// CalculateHistoricalVaRLevels); horizon 1 gives exactly that function's result.
+//
+// Outputs are numHorizons x numLevels, row-major (horizon k, level l at
+// [k * numLevels + l]). Horizons below 1 or leaving fewer than 2 windows,
+// levels outside (0, 1) and unknown compounding modes report 0. Either output
+// may be null.
+void CalculateMultiHorizonVaR(double* returns, int length, int* horizons, int numHorizons,
+                              double* confidenceLevels, int numLevels, int compounding,
+                              double* valueAtRisk, double* expectedShortfall);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MULTI_HORIZON_VAR_H
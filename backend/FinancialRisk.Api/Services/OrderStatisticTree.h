@@ -0,0 +1,88 @@
+#ifndef ORDER_STATISTIC_TREE_H
+#define ORDER_STATISTIC_TREE_H
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+namespace RiskKernels {
+
+    // Sliding-window order statistics over a fixed series. Values are ranked
+    // once (ties broken by position, so every observation has its own rank);
+    // two Fenwick trees over the ranks hold the window's counts and value sums.
+    // Insert, remove, k-th smallest and "sum of the k smallest" are all
+    // O(log length).
+    class OrderStatisticTree {
+    public:
+        OrderStatisticTree(const double* values, int length)
+            : size(length), ranks(length), sortedValues(length), counts(length + 1, 0), sums(length + 1, 0.0) {
+            std::vector<int> order(length);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [values](int a, int b) { return values[a] < values[b]; });
+            for (int rank = 0; rank < length; ++rank) {
+                ranks[order[rank]] = rank;
+                sortedValues[rank] = values[order[rank]];
+            }
+            topBit = 1;
+            while (topBit * 2 <= length) topBit *= 2;
+        }
+
+        // Add / remove observation 'position' of the series
+        void insert(int position) { update(ranks[position], 1, sortedValues[ranks[position]]); }
+        void remove(int position) { update(ranks[position], -1, -sortedValues[ranks[position]]); }
+
+        int count() const { return active; }
+
+        // Rank of the k-th smallest value in the window (k is 0-based)
+        int kthRank(int k) const {
+            int position = 0;
+            int remaining = k + 1;
+            for (int step = topBit; step > 0; step >>= 1) {
+                int next = position + step;
+                if (next <= size && counts[next] < remaining) {
+                    position = next;
+                    remaining -= counts[next];
+                }
+            }
+            // position is the last Fenwick index whose prefix count is <= k, so
+            // the k-th smallest sits at Fenwick index position + 1 (rank position)
+            return position;
+        }
+
+        double kth(int k) const { return sortedValues[kthRank(k)]; }
+
+        // Sum of the k smallest values in the window
+        double sumSmallest(int k) const {
+            if (k <= 0) return 0.0;
+            return prefixSum(kthRank(k - 1));
+        }
+
+    private:
+        void update(int rank, int delta, double value) {
+            active += delta;
+            for (int i = rank + 1; i <= size; i += i & -i) {
+                counts[i] += delta;
+                sums[i] += value;
+            }
+        }
+
+        // Sum of window values with rank <= rank
+        double prefixSum(int rank) const {
+            double total = 0.0;
+            for (int i = rank + 1; i > 0; i -= i & -i) {
+                total += sums[i];
+            }
+            return total;
+        }
+
+        int size;
+        int topBit;
+        int active = 0;
+        std::vector<int> ranks;
+        std::vector<double> sortedValues;
+        std::vector<int> counts;
+        std::vector<double> sums;
+    };
+}
+
+#endif // ORDER_STATISTIC_TREE_H
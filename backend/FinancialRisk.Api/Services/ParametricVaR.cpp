@@ -0,0 +1,165 @@
+#include "ParametricVaR.h"
+#include "DistributionKernels.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Independent accumulators per power sum; wide enough for one AVX-512
+    // register or two AVX2 registers
+    const int Lanes = 8;
+    // Assets handed to a worker at a time
+    const int AssetGrain = 8;
+    const double MaxDegreesOfFreedom = 1000.0;
+    
+    struct SeriesMoments {
+        double mean;
+        double stdDev;          // sample (n - 1) standard deviation
+        double skewness;
+        double excessKurtosis;
+    };
+    
+    // Moments from one pass of power sums of x - x[0]. The shift keeps the
+    // sums on the scale of the deviations, so the central moments recovered
+    // from them do not cancel away.
+    SeriesMoments seriesMoments(const double* series, int length) {
+        const double shift = series[0];
+        double s1[Lanes] = {}, s2[Lanes] = {}, s3[Lanes] = {}, s4[Lanes] = {};
+        int t = 0;
+        for (; t + Lanes <= length; t += Lanes) {
+            for (int k = 0; k < Lanes; ++k) {
+                const double d = series[t + k] - shift;
+                const double d2 = d * d;
+                s1[k] += d;
+                s2[k] += d2;
+                s3[k] += d2 * d;
+                s4[k] += d2 * d2;
+            }
+        }
+        for (; t < length; ++t) {
+            const double d = series[t] - shift;
+            const double d2 = d * d;
+            s1[0] += d;
+            s2[0] += d2;
+            s3[0] += d2 * d;
+            s4[0] += d2 * d2;
+        }
+        double sum1 = 0.0, sum2 = 0.0, sum3 = 0.0, sum4 = 0.0;
+        for (int k = 0; k < Lanes; ++k) {
+            sum1 += s1[k];
+            sum2 += s2[k];
+            sum3 += s3[k];
+            sum4 += s4[k];
+        }
+        
+        const double n = static_cast<double>(length);
+        const double m = sum1 / n;
+        const double r2 = sum2 / n, r3 = sum3 / n, r4 = sum4 / n;
+        const double m2 = std::max(0.0, r2 - m * m);
+        const double m3 = r3 - 3.0 * m * r2 + 2.0 * m * m * m;
+        const double m4 = r4 - 4.0 * m * r3 + 6.0 * m * m * r2 - 3.0 * m * m * m * m;
+        
+        SeriesMoments moments{shift + m, std::sqrt(m2 * n / (n - 1.0)), 0.0, 0.0};
+        if (m2 > 0.0) {
+            moments.skewness = m3 / (m2 * std::sqrt(m2));
+            moments.excessKurtosis = m4 / (m2 * m2) - 3.0;
+        }
+        return moments;
+    }
+    
+    // Normal terms of one confidence level; tail = 0 marks an invalid level
+    struct LevelTerms {
+        double tail;
+        double z;        // standard normal quantile of the tail (negative for c > 0.5)
+        double density;  // phi(z)
+    };
+    
+    // Quantile and expected shortfall, both as losses, of a unit-variance
+    // Student-t with nu > 2 degrees of freedom at tail probability tail
+    void standardizedStudentT(double tail, double nu, double& quantile, double& shortfall) {
+        const double q = RiskKernels::studentTQuantile(1.0 - tail, nu);
+        const double scale = std::sqrt((nu - 2.0) / nu);
+        quantile = scale * q;
+        shortfall = scale * RiskKernels::studentTDensity(q, nu) * (nu + q * q) / ((nu - 1.0) * tail);
+    }
+    
+    // Degrees of freedom matching the excess kurtosis 6 / (nu - 4)
+    double kurtosisDegreesOfFreedom(double excessKurtosis) {
+        if (excessKurtosis <= 6.0 / (MaxDegreesOfFreedom - 4.0)) return MaxDegreesOfFreedom;
+        return 4.0 + 6.0 / excessKurtosis;
+    }
+}
+
+extern "C" {
+    // Batch parametric VaR/ES (normal, Cornish-Fisher, Student-t)
+    void CalculateBatchParametricVaR(double* assetReturns, int numAssets, int length,
+                                     double* confidenceLevels, int numLevels, int model, double degreesOfFreedom,
+                                     double* valueAtRisk, double* expectedShortfall) {
+        if (assetReturns == nullptr || confidenceLevels == nullptr || numAssets <= 0 || numLevels <= 0) return;
+        const size_t total = static_cast<size_t>(numAssets) * numLevels;
+        if (valueAtRisk) std::fill(valueAtRisk, valueAtRisk + total, 0.0);
+        if (expectedShortfall) std::fill(expectedShortfall, expectedShortfall + total, 0.0);
+        if (length < 2) return;
+        if (model != PARAMETRIC_NORMAL && model != PARAMETRIC_CORNISH_FISHER && model != PARAMETRIC_STUDENT_T) return;
+        
+        std::vector<LevelTerms> terms(numLevels, LevelTerms{0.0, 0.0, 0.0});
+        for (int level = 0; level < numLevels; ++level) {
+            const double confidenceLevel = confidenceLevels[level];
+            if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) continue;
+            const double z = -RiskKernels::inverseNormal(confidenceLevel);
+            terms[level] = LevelTerms{1.0 - confidenceLevel, z, RiskKernels::normalDensity(z)};
+        }
+        
+        // A fixed nu shares its t quantiles across assets
+        const bool fixedStudentT = model == PARAMETRIC_STUDENT_T && degreesOfFreedom > 2.0;
+        std::vector<double> fixedQuantile(numLevels, 0.0), fixedShortfall(numLevels, 0.0);
+        if (fixedStudentT) {
+            for (int level = 0; level < numLevels; ++level) {
+                if (terms[level].tail > 0.0) {
+                    standardizedStudentT(terms[level].tail, degreesOfFreedom, fixedQuantile[level], fixedShortfall[level]);
+                }
+            }
+        }
+        
+        RiskKernels::parallelFor(numAssets, AssetGrain, [&](int begin, int end) {
+            std::vector<double> quantile(numLevels), shortfall(numLevels);
+            for (int asset = begin; asset < end; ++asset) {
+                const SeriesMoments moments = seriesMoments(assetReturns + static_cast<size_t>(asset) * length, length);
+                const double mean = moments.mean, sigma = moments.stdDev;
+                const double S = moments.skewness, K = moments.excessKurtosis;
+                
+                // Standardized loss quantile and shortfall of every valid level
+                for (int level = 0; level < numLevels; ++level) {
+                    const LevelTerms& term = terms[level];
+                    if (term.tail <= 0.0) continue;
+                    const double z = term.z, phi = term.density, z2 = z * z;
+                    if (model == PARAMETRIC_NORMAL) {
+                        quantile[level] = -z;
+                        shortfall[level] = phi / term.tail;
+                    } else if (model == PARAMETRIC_CORNISH_FISHER) {
+                        quantile[level] = -(z + (z2 - 1.0) * S / 6.0 + (z2 * z - 3.0 * z) * K / 24.0
+                                            - (2.0 * z2 * z - 5.0 * z) * S * S / 36.0);
+                        // Partial moments of the normal below z
+                        const double m0 = term.tail, m1 = -phi, m2 = term.tail - z * phi, m3 = -(z2 + 2.0) * phi;
+                        const double integral = m1 + (m2 - m0) * S / 6.0 + (m3 - 3.0 * m1) * K / 24.0
+                                                - (2.0 * m3 - 5.0 * m1) * S * S / 36.0;
+                        shortfall[level] = -integral / term.tail;
+                    } else if (fixedStudentT) {
+                        quantile[level] = fixedQuantile[level];
+                        shortfall[level] = fixedShortfall[level];
+                    } else {
+                        standardizedStudentT(term.tail, kurtosisDegreesOfFreedom(K), quantile[level], shortfall[level]);
+                    }
+                }
+                
+                const size_t row = static_cast<size_t>(asset) * numLevels;
+                for (int level = 0; level < numLevels; ++level) {
+                    if (terms[level].tail <= 0.0) continue;
+                    if (valueAtRisk) valueAtRisk[row + level] = -(mean - sigma * quantile[level]);
+                    if (expectedShortfall) expectedShortfall[row + level] = -(mean - sigma * shortfall[level]);
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef PARAMETRIC_VAR_H
+#define PARAMETRIC_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Distribution used by CalculateBatchParametricVaR
+#define PARAMETRIC_NORMAL 0
+#define PARAMETRIC_CORNISH_FISHER 1
+#define PARAMETRIC_STUDENT_T 2
+
+// Parametric VaR and ES of many assets at several confidence levels.
+//
+// assetReturns holds numAssets series of length observations, one after
+// another. Each series is read once: mean, variance, skewness S and excess
+// kurtosis K come from shifted power sums kept in vector lanes, and assets are
+// split across a thread pool. Outputs are numAssets x numLevels, row-major
+// (asset a, level l at [a * numLevels + l]).
+//
+// With z the standard normal quantile of the tail 1 - c (AS241):
+//   PARAMETRIC_NORMAL         VaR = -(mean + sigma z), ES = -(mean - sigma phi(z) / (1 - c)),
+//                             as CalculateParametricVaRLevels
+//   PARAMETRIC_CORNISH_FISHER z is replaced by the modified quantile
+//                             z + (z^2 - 1) S/6 + (z^3 - 3z) K/24 - (2z^3 - 5z) S^2/36,
+//                             and ES integrates the same expansion over the normal tail
+//   PARAMETRIC_STUDENT_T      Student-t with nu = degreesOfFreedom, scaled to the
+//                             sample variance. If degreesOfFreedom <= 2, nu is
+//                             estimated per asset from the excess kurtosis
+//                             (nu = 4 + 6/K, at most 1000).
+//
+// sigma is the sample standard deviation; S and K are the moment estimators
+// m3 / m2^1.5 and m4 / m2^2 - 3. Levels outside (0, 1), series shorter than 2
+// and unknown models report 0. Either output may be null.
+void CalculateBatchParametricVaR(double* assetReturns, int numAssets, int length,
+                                 double* confidenceLevels, int numLevels, int model, double degreesOfFreedom,
+                                 double* valueAtRisk, double* expectedShortfall);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PARAMETRIC_VAR_H
@@ -0,0 +1,125 @@
+#include "PortfolioBatchVaR.h"
+#include "QuantileKernels.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+
+namespace {
+    // Register tile of the multiply: RowTile scenarios x PanelWidth portfolios
+    const int RowTile = 4;
+    const int PanelWidth = 8;
+    // Portfolios per worker block; the block's packed panels stay in L2
+    const int PortfolioBlock = 64;
+    
+    // Copy the weight columns [first, first + PortfolioBlock) into panels of
+    // PanelWidth portfolios, each numAssets x PanelWidth and contiguous; columns
+    // past the last portfolio are zero
+    void packWeights(const double* weights, int numAssets, int numPortfolios, int first, double* panels) {
+        const int numPanels = PortfolioBlock / PanelWidth;
+        for (int panel = 0; panel < numPanels; ++panel) {
+            double* out = panels + static_cast<size_t>(panel) * numAssets * PanelWidth;
+            for (int a = 0; a < numAssets; ++a) {
+                for (int k = 0; k < PanelWidth; ++k) {
+                    int portfolio = first + panel * PanelWidth + k;
+                    out[a * PanelWidth + k] = portfolio < numPortfolios
+                        ? weights[static_cast<size_t>(a) * numPortfolios + portfolio] : 0.0;
+                }
+            }
+        }
+    }
+    
+    // acc = rows x panel, with rows[r] pointing at RowTile scenario rows
+    inline void multiplyTile(const double* const* rows, const double* panel, int numAssets,
+                             double acc[RowTile][PanelWidth]) {
+        for (int r = 0; r < RowTile; ++r) {
+            for (int k = 0; k < PanelWidth; ++k) acc[r][k] = 0.0;
+        }
+        for (int a = 0; a < numAssets; ++a) {
+            const double* w = panel + a * PanelWidth;
+            for (int r = 0; r < RowTile; ++r) {
+                const double s = rows[r][a];
+                for (int k = 0; k < PanelWidth; ++k) {
+                    acc[r][k] += s * w[k];
+                }
+            }
+        }
+    }
+    
+    // P&L of portfolios [first, first + count) into pnl, one numScenarios row per portfolio
+    void blockPnL(const double* scenarioReturns, int numScenarios, int numAssets, const double* panels,
+                  int count, double* pnl) {
+        double acc[RowTile][PanelWidth];
+        const double* rows[RowTile];
+        const int numPanels = (count + PanelWidth - 1) / PanelWidth;
+        
+        for (int t = 0; t < numScenarios; t += RowTile) {
+            const int height = std::min(RowTile, numScenarios - t);
+            for (int r = 0; r < RowTile; ++r) {
+                // Short last tile: repeat the first row and drop the result
+                rows[r] = scenarioReturns + static_cast<size_t>(t + (r < height ? r : 0)) * numAssets;
+            }
+            for (int panel = 0; panel < numPanels; ++panel) {
+                multiplyTile(rows, panels + static_cast<size_t>(panel) * numAssets * PanelWidth, numAssets, acc);
+                const int width = std::min(PanelWidth, count - panel * PanelWidth);
+                for (int k = 0; k < width; ++k) {
+                    double* out = pnl + static_cast<size_t>(panel * PanelWidth + k) * numScenarios;
+                    for (int r = 0; r < height; ++r) {
+                        out[t + r] = acc[r][k];
+                    }
+                }
+            }
+        }
+    }
+}
+
+extern "C" {
+    // Historical VaR/CVaR of many weight vectors over shared scenarios
+    void CalculatePortfolioBatchVaR(double* scenarioReturns, int numScenarios, int numAssets,
+                                    double* weights, int numPortfolios,
+                                    double* confidenceLevels, int numLevels,
+                                    double* valueAtRisk, double* conditionalVaR) {
+        if (scenarioReturns == nullptr || weights == nullptr || confidenceLevels == nullptr) return;
+        if (numAssets <= 0 || numPortfolios <= 0 || numLevels <= 0) return;
+        
+        // Invalid levels report 0 like CalculateHistoricalVaRLevels; the rest share one selection
+        const size_t total = static_cast<size_t>(numPortfolios) * numLevels;
+        if (valueAtRisk) std::fill(valueAtRisk, valueAtRisk + total, 0.0);
+        if (conditionalVaR) std::fill(conditionalVaR, conditionalVaR + total, 0.0);
+        std::vector<double> levels;
+        std::vector<int> positions;
+        for (int level = 0; level < numLevels; ++level) {
+            if (numScenarios >= 2 && confidenceLevels[level] > 0.0 && confidenceLevels[level] < 1.0) {
+                levels.push_back(confidenceLevels[level]);
+                positions.push_back(level);
+            }
+        }
+        if (levels.empty()) return;
+        const int valid = static_cast<int>(levels.size());
+        
+        const int numBlocks = (numPortfolios + PortfolioBlock - 1) / PortfolioBlock;
+        RiskKernels::parallelFor(numBlocks, 1, [&](int begin, int end) {
+            std::vector<double> panels(static_cast<size_t>(PortfolioBlock) * numAssets);
+            std::vector<double> pnl(static_cast<size_t>(PortfolioBlock) * numScenarios);
+            std::vector<double> var(valid), cvar(valid);
+            
+            for (int block = begin; block < end; ++block) {
+                const int first = block * PortfolioBlock;
+                const int count = std::min(PortfolioBlock, numPortfolios - first);
+                packWeights(weights, numAssets, numPortfolios, first, panels.data());
+                blockPnL(scenarioReturns, numScenarios, numAssets, panels.data(), count, pnl.data());
+                
+                for (int i = 0; i < count; ++i) {
+                    double* work = pnl.data() + static_cast<size_t>(i) * numScenarios;
+                    int maxTail = RiskKernels::selectVaRLevels(work, numScenarios, levels.data(), valid, var.data());
+                    RiskKernels::tailAveragesOfLevels(work, numScenarios, levels.data(), valid, maxTail, cvar.data());
+                    
+                    const size_t row = static_cast<size_t>(first + i) * numLevels;
+                    for (int l = 0; l < valid; ++l) {
+                        if (valueAtRisk) valueAtRisk[row + positions[l]] = var[l];
+                        if (conditionalVaR) conditionalVaR[row + positions[l]] = cvar[l];
+                    }
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef PORTFOLIO_BATCH_VAR_H
+#define PORTFOLIO_BATCH_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Historical VaR and CVaR of many portfolios over one shared scenario matrix.
+//
+// scenarioReturns is numScenarios x numAssets (row per scenario) and weights is
+// numAssets x numPortfolios (column per portfolio), both row-major. The
+// scenario P&L of every portfolio (scenarioReturns x weights) comes from a
+// cache-blocked multiply split across a thread pool: blocks of portfolios are
+// handed to workers, which pack their weight columns into panels and sweep the
+// scenarios a few rows at a time. Each portfolio's P&L then goes through the
+// nested selection of CalculateHistoricalVaRLevels.
+//
+// valueAtRisk and conditionalVaR receive numPortfolios x numLevels values (row
+// per portfolio), matching CalculateHistoricalVaRLevels on each portfolio's
+// P&L. Levels outside (0, 1) report 0. Either output may be null.
+void CalculatePortfolioBatchVaR(double* scenarioReturns, int numScenarios, int numAssets,
+                                double* weights, int numPortfolios,
+                                double* confidenceLevels, int numLevels,
+                                double* valueAtRisk, double* conditionalVaR);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PORTFOLIO_BATCH_VAR_H
@@ -1,4 +1,6 @@
 #include "QuantEngine.h"
+#include "QuantileKernels.h"
+#include "DistributionKernels.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -26,14 +28,8 @@ extern "C" double CalculateVaRHistorical(const double* returns, int length, doub
             return 0.0;
         }
         
-        std::vector<double> returnsVec(returns, returns + length);
-        std::sort(returnsVec.begin(), returnsVec.end());
-        
-        int index = static_cast<int>((1 - confidenceLevel) * length);
-        if (index >= length) index = length - 1;
-        if (index < 0) index = 0;
-        
-        return -returnsVec[index];
+        int index = RiskKernels::historicalVaRIndex(confidenceLevel, length);
+        return -RiskKernels::selectOrderStatistic(returns, length, index);
     }
     catch (const std::exception& e) {
         setError(2, std::string("Exception in VaR calculation: ") + e.what());
@@ -48,8 +44,8 @@ extern "C" double CalculateVaRParametric(double mean, double std, double confide
             return 0.0;
         }
         
-        // Z-score for given confidence level
-        double zScore = std::sqrt(2) * std::erfc(2 * confidenceLevel - 1);
+        // Z-score of the loss tail (negative for confidence levels above 0.5)
+        double zScore = RiskKernels::inverseNormal(1.0 - confidenceLevel);
         return -(mean + zScore * std);
     }
     catch (const std::exception& e) {
@@ -67,21 +63,21 @@ extern "C" double CalculateCVaR(const double* returns, int length, double confid
         
         double var = CalculateVaRHistorical(returns, length, confidenceLevel);
         
-        std::vector<double> returnsVec(returns, returns + length);
-        std::vector<double> tailReturns;
-        
-        for (double ret : returnsVec) {
-            if (ret <= -var) {
-                tailReturns.push_back(ret);
+        // Average every return at or below the VaR threshold in one pass
+        double sum = 0.0;
+        int tailCount = 0;
+        for (int i = 0; i < length; ++i) {
+            if (returns[i] <= -var) {
+                sum += returns[i];
+                ++tailCount;
             }
         }
         
-        if (tailReturns.empty()) {
+        if (tailCount == 0) {
             return var;
         }
         
-        double sum = std::accumulate(tailReturns.begin(), tailReturns.end(), 0.0);
-        return -sum / tailReturns.size();
+        return -sum / tailCount;
     }
     catch (const std::exception& e) {
         setError(6, std::string("Exception in CVaR calculation: ") + e.what());
@@ -478,14 +474,11 @@ std::vector<double> RiskParityOptimizer::optimize(const std::vector<double>& exp
 }
 
 double HistoricalVaRCalculator::calculate(const std::vector<double>& returns, double confidenceLevel) {
-    std::vector<double> sortedReturns = returns;
-    std::sort(sortedReturns.begin(), sortedReturns.end());
-    
-    int index = static_cast<int>((1 - confidenceLevel) * returns.size());
-    if (index >= returns.size()) index = returns.size() - 1;
-    if (index < 0) index = 0;
+    if (returns.empty()) return 0.0;
     
-    return -sortedReturns[index];
+    int length = static_cast<int>(returns.size());
+    int index = RiskKernels::historicalVaRIndex(confidenceLevel, length);
+    return -RiskKernels::selectOrderStatistic(returns.data(), length, index);
 }
 
 double ParametricVaRCalculator::calculate(const std::vector<double>& returns, double confidenceLevel) {
@@ -498,7 +491,7 @@ double ParametricVaRCalculator::calculate(const std::vector<double>& returns, do
     }
     double std = std::sqrt(variance / (returns.size() - 1));
     
-    double zScore = std::sqrt(2) * std::erfc(2 * confidenceLevel - 1);
+    double zScore = RiskKernels::inverseNormal(1.0 - confidenceLevel);
     return -(mean + zScore * std);
 }
 
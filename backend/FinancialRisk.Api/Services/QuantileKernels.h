@@ -0,0 +1,104 @@
+#ifndef QUANTILE_KERNELS_H
+#define QUANTILE_KERNELS_H
+
+#include <vector>
+#include <algorithm>
+
+// Selection-based order statistics shared by the historical VaR/ES functions
+// of the RiskCalculations, VaRCalculations and QuantEngine libraries. One
+// introselect (std::nth_element) replaces the full sort: O(n) instead of
+// O(n log n), and the tail sum only touches the values left of the pivot.
+namespace RiskKernels {
+
+    // Order-statistic index used by the historical VaR functions
+    inline int historicalVaRIndex(double confidenceLevel, int length) {
+        int index = static_cast<int>((1.0 - confidenceLevel) * length);
+        if (index >= length) index = length - 1;
+        if (index < 0) index = 0;
+        return index;
+    }
+
+    // Number of observations averaged by the historical ES functions
+    inline int historicalTailCount(double confidenceLevel, int length) {
+        int count = static_cast<int>((1.0 - confidenceLevel) * length);
+        if (count <= 0) count = 1;
+        if (count > length) count = length;
+        return count;
+    }
+
+    // Per-thread working copy, reused across calls so repeated VaR requests do
+    // not allocate. It keeps the capacity of the largest input seen.
+    template <typename Real>
+    inline Real* quantileScratch(const Real* values, int length) {
+        thread_local std::vector<Real> scratch;
+        if (static_cast<int>(scratch.size()) < length) scratch.resize(length);
+        std::copy(values, values + length, scratch.begin());
+        return scratch.data();
+    }
+
+    // k-th smallest value (0-based) of values[0, length)
+    template <typename Real>
+    inline Real selectOrderStatistic(const Real* values, int length, int k) {
+        Real* work = quantileScratch(values, length);
+        std::nth_element(work, work + k, work + length);
+        return work[k];
+    }
+
+    // Partition work[0, length) in place so the VaR order statistic of every
+    // level is in its sorted position and write -value to valueAtRisk[level].
+    // Selection runs from the largest index down, so each nth_element only
+    // partitions the prefix the previous one left. Afterwards the first k
+    // elements are the k smallest for every k a level needs, so tail sums are
+    // prefix sums. Returns the largest tail count of the levels.
+    template <typename Real>
+    inline int selectVaRLevels(Real* work, int length, const double* confidenceLevels, int numLevels,
+                               double* valueAtRisk) {
+        std::vector<int> order(numLevels);
+        for (int level = 0; level < numLevels; ++level) order[level] = level;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return historicalVaRIndex(confidenceLevels[a], length) > historicalVaRIndex(confidenceLevels[b], length);
+        });
+
+        int maxTail = 0;
+        int upperBound = length;
+        for (int level : order) {
+            int index = historicalVaRIndex(confidenceLevels[level], length);
+            std::nth_element(work, work + index, work + upperBound);
+            valueAtRisk[level] = -static_cast<double>(work[index]);
+            upperBound = std::max(index, 1);
+            maxTail = std::max(maxTail, historicalTailCount(confidenceLevels[level], length));
+        }
+        return maxTail;
+    }
+
+    // Expected shortfall of every level from one prefix-sum pass over a buffer
+    // partitioned by selectVaRLevels
+    template <typename Real>
+    inline void tailAveragesOfLevels(const Real* work, int length, const double* confidenceLevels, int numLevels,
+                                     int maxTail, double* expectedShortfall) {
+        std::vector<double> prefixSums(maxTail + 1, 0.0);
+        for (int i = 0; i < maxTail; ++i) {
+            prefixSums[i + 1] = prefixSums[i] + work[i];
+        }
+        for (int level = 0; level < numLevels; ++level) {
+            int count = historicalTailCount(confidenceLevels[level], length);
+            expectedShortfall[level] = -(prefixSums[count] / count);
+        }
+    }
+
+    // Sum of the count smallest values of values[0, length), accumulated in double
+    template <typename Real>
+    inline double sumSmallest(const Real* values, int length, int count) {
+        Real* work = quantileScratch(values, length);
+        if (count < length) {
+            std::nth_element(work, work + (count - 1), work + length);
+        }
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) {
+            sum += work[i];
+        }
+        return sum;
+    }
+}
+
+#endif // QUANTILE_KERNELS_H
@@ -0,0 +1,109 @@
+#ifndef RANDOM_STREAMS_H
+#define RANDOM_STREAMS_H
+
+#include <cstdint>
+#include <cmath>
+
+// Reproducible random streams for the resampling engines. A stream is keyed
+// by (seed, stream id), typically one stream per replicate, so results do not
+// depend on how replicates are spread over threads. Draws are built on the
+// generator here rather than on <random> distributions, whose algorithms are
+// implementation-defined, so a seed gives the same results with any standard
+// library.
+namespace RiskKernels {
+
+    inline uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // xoshiro256** generator, state expanded from (seed, stream) with SplitMix64.
+    // Also a UniformRandomBitGenerator, so <random> distributions can draw from it.
+    class RandomStream {
+    public:
+        using result_type = uint64_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+        RandomStream(uint64_t seed, uint64_t stream) {
+            uint64_t state = seed ^ splitMix64(stream);
+            for (uint64_t& word : s) {
+                word = splitMix64(state);
+            }
+        }
+
+        uint64_t next() {
+            const uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        result_type operator()() {
+            return next();
+        }
+
+        // Uniform integer in [0, bound) without modulo bias (Lemire's method)
+        uint32_t nextIndex(uint32_t bound) {
+            uint64_t product = static_cast<uint64_t>(static_cast<uint32_t>(next() >> 32)) * bound;
+            uint32_t low = static_cast<uint32_t>(product);
+            if (low < bound) {
+                const uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+                while (low < threshold) {
+                    product = static_cast<uint64_t>(static_cast<uint32_t>(next() >> 32)) * bound;
+                    low = static_cast<uint32_t>(product);
+                }
+            }
+            return static_cast<uint32_t>(product >> 32);
+        }
+
+        // Uniform double in [0, 1)
+        double nextUniform() {
+            return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        // Binomial(trials, p) for 0 <= p <= 1/2. Small means walk the pmf up
+        // from zero (inversion, about mean + 1 steps); larger means, where
+        // (1 - p)^trials can underflow, count geometric waiting times between
+        // successes (about mean + 1 logarithms).
+        int nextBinomial(int trials, double p) {
+            if (trials <= 0 || !(p > 0.0)) return 0;
+            if (trials * p <= 30.0) {
+                const double ratio = p / (1.0 - p);
+                double pmf = std::exp(trials * std::log1p(-p));
+                double u = nextUniform();
+                int k = 0;
+                while (u > pmf && k < trials) {
+                    u -= pmf;
+                    pmf *= ratio * (trials - k) / (k + 1);
+                    ++k;
+                }
+                return k;
+            }
+            const double logFailure = std::log1p(-p);
+            double position = 0.0;
+            int successes = 0;
+            while (true) {
+                position += std::floor(std::log(1.0 - nextUniform()) / logFailure) + 1.0;
+                if (position > trials) return successes;
+                ++successes;
+            }
+        }
+
+    private:
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        uint64_t s[4];
+    };
+}
+
+#endif // RANDOM_STREAMS_H
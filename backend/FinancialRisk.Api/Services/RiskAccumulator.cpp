@@ -0,0 +1,170 @@
+#include "RiskAccumulator.h"
+#include "DrawdownQueue.h"
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+
+struct RiskAccumulator {
+    int windowLength;
+    bool trackBenchmark;
+    double riskFreeRate;
+    double downsideTarget;
+    
+    // Stored observations (needed to remove the oldest one)
+    std::deque<std::pair<double, double>> observations;
+    
+    // Welford moments and co-moments
+    long long count = 0;
+    double meanAsset = 0.0, meanBenchmark = 0.0;
+    double m2Asset = 0.0, m2Benchmark = 0.0, coMoment = 0.0;
+    
+    // Downside moments below the fixed target
+    double downsideSum = 0.0;
+    long long downsideCount = 0;
+    
+    // Cumulative (additive) return levels, including the level before the
+    // oldest observation, matching CalculateMaximumDrawdown
+    double cumulative = 0.0;
+    RiskKernels::DrawdownQueue levels;
+    
+    RiskAccumulator(int window, bool benchmark, double rf, double target)
+        : windowLength(window), trackBenchmark(benchmark), riskFreeRate(rf), downsideTarget(target) {
+        levels.push(0.0);
+    }
+    
+    void append(double asset, double benchmark) {
+        if (!trackBenchmark) benchmark = 0.0;
+        if (windowLength > 0 && static_cast<int>(observations.size()) >= windowLength) {
+            removeOldest();
+        }
+        observations.emplace_back(asset, benchmark);
+        
+        ++count;
+        double deltaAsset = asset - meanAsset;
+        meanAsset += deltaAsset / count;
+        double deltaBenchmark = benchmark - meanBenchmark;
+        meanBenchmark += deltaBenchmark / count;
+        m2Asset += deltaAsset * (asset - meanAsset);
+        m2Benchmark += deltaBenchmark * (benchmark - meanBenchmark);
+        coMoment += deltaAsset * (benchmark - meanBenchmark);
+        
+        if (asset < downsideTarget) {
+            double diff = asset - downsideTarget;
+            downsideSum += diff * diff;
+            ++downsideCount;
+        }
+        
+        cumulative += asset;
+        levels.push(cumulative);
+    }
+    
+    bool removeOldest() {
+        if (observations.empty()) return false;
+        double asset = observations.front().first;
+        double benchmark = observations.front().second;
+        observations.pop_front();
+        levels.pop();
+        
+        if (asset < downsideTarget) {
+            double diff = asset - downsideTarget;
+            downsideSum -= diff * diff;
+            --downsideCount;
+        }
+        
+        if (--count == 0) {
+            meanAsset = meanBenchmark = m2Asset = m2Benchmark = coMoment = 0.0;
+            downsideSum = 0.0;
+            downsideCount = 0;
+            return true;
+        }
+        
+        // Reverse Welford update
+        double oldMeanAsset = meanAsset;
+        double oldMeanBenchmark = meanBenchmark;
+        meanAsset -= (asset - meanAsset) / count;
+        meanBenchmark -= (benchmark - meanBenchmark) / count;
+        m2Asset = std::max(0.0, m2Asset - (asset - meanAsset) * (asset - oldMeanAsset));
+        m2Benchmark = std::max(0.0, m2Benchmark - (benchmark - meanBenchmark) * (benchmark - oldMeanBenchmark));
+        coMoment -= (asset - meanAsset) * (benchmark - oldMeanBenchmark);
+        return true;
+    }
+    
+    void query(StreamingRiskMetrics& metrics) const {
+        metrics = StreamingRiskMetrics{};
+        metrics.count = static_cast<int>(count);
+        metrics.mean = meanAsset;
+        if (count < 2) return;
+        
+        metrics.maximumDrawdown = levels.maximumDrawdown();
+        
+        const double n = static_cast<double>(count);
+        const double volatility = std::sqrt(m2Asset / (n - 1) * 252.0);
+        metrics.volatility = volatility;
+        if (volatility != 0.0) {
+            metrics.sharpeRatio = (meanAsset * 252.0 - riskFreeRate) / volatility;
+        }
+        
+        if (downsideCount > 0) {
+            double downsideDeviation = std::sqrt(std::max(0.0, downsideSum) / downsideCount * 252.0);
+            if (downsideDeviation != 0.0) {
+                metrics.sortinoRatio = (meanAsset * 252.0 - riskFreeRate) / downsideDeviation;
+            }
+        }
+        
+        if (trackBenchmark) {
+            if (m2Benchmark > 0.0) {
+                metrics.beta = coMoment / m2Benchmark;
+            }
+            // Excess-return variance from the asset/benchmark co-moments
+            double excessM2 = std::max(0.0, m2Asset + m2Benchmark - 2.0 * coMoment);
+            double trackingError = std::sqrt(excessM2 / (n - 1)) * std::sqrt(252.0);
+            if (trackingError != 0.0) {
+                metrics.informationRatio = (meanAsset - meanBenchmark) * 252.0 / trackingError;
+            }
+        }
+    }
+};
+
+extern "C" {
+    // Create a streaming accumulator
+    RiskAccumulator* CreateRiskAccumulator(int windowLength, int trackBenchmark,
+                                           double riskFreeRate, double downsideTarget) {
+        return new RiskAccumulator(std::max(0, windowLength), trackBenchmark != 0, riskFreeRate, downsideTarget);
+    }
+    
+    // Destroy a streaming accumulator
+    void DestroyRiskAccumulator(RiskAccumulator* accumulator) {
+        delete accumulator;
+    }
+    
+    // Append one observation
+    void AppendRiskObservation(RiskAccumulator* accumulator, double assetReturn, double benchmarkReturn) {
+        if (accumulator == nullptr) return;
+        accumulator->append(assetReturn, benchmarkReturn);
+    }
+    
+    // Append a block of observations
+    void AppendRiskObservations(RiskAccumulator* accumulator, double* assetReturns, double* benchmarkReturns, int count) {
+        if (accumulator == nullptr || assetReturns == nullptr) return;
+        for (int i = 0; i < count; ++i) {
+            accumulator->append(assetReturns[i], benchmarkReturns ? benchmarkReturns[i] : 0.0);
+        }
+    }
+    
+    // Remove the oldest observation
+    int RemoveOldestRiskObservation(RiskAccumulator* accumulator) {
+        if (accumulator == nullptr) return 0;
+        return accumulator->removeOldest() ? 1 : 0;
+    }
+    
+    // Read the current metrics
+    void QueryRiskAccumulator(RiskAccumulator* accumulator, StreamingRiskMetrics* metrics) {
+        if (metrics == nullptr) return;
+        if (accumulator == nullptr) {
+            *metrics = StreamingRiskMetrics{};
+            return;
+        }
+        accumulator->query(*metrics);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef RISK_ACCUMULATOR_H
+#define RISK_ACCUMULATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Opaque streaming accumulator. Appending or removing one observation costs
+// O(1) (amortized for the drawdown), so an end-of-day refresh does not
+// rescan the whole history.
+typedef struct RiskAccumulator RiskAccumulator;
+
+// Metrics available from the accumulator at any time
+typedef struct StreamingRiskMetrics {
+    int count;
+    double mean;
+    double volatility;
+    double sharpeRatio;
+    double sortinoRatio;
+    double maximumDrawdown;
+    double beta;
+    double informationRatio;
+} StreamingRiskMetrics;
+
+// Create an accumulator. windowLength > 0 keeps a fixed window (the oldest
+// observation is dropped automatically once it is full); 0 keeps every
+// observation. Benchmark co-moments are tracked when trackBenchmark != 0.
+// The Sortino ratio uses downside deviation below the fixed downsideTarget
+// (a running mean cannot be used as the threshold in O(1)).
+RiskAccumulator* CreateRiskAccumulator(int windowLength, int trackBenchmark,
+                                       double riskFreeRate, double downsideTarget);
+
+// Release an accumulator created by CreateRiskAccumulator
+void DestroyRiskAccumulator(RiskAccumulator* accumulator);
+
+// Append one observation (benchmarkReturn is ignored unless tracked)
+void AppendRiskObservation(RiskAccumulator* accumulator, double assetReturn, double benchmarkReturn);
+
+// Append a block of observations, e.g. to seed from history. benchmarkReturns may be null.
+void AppendRiskObservations(RiskAccumulator* accumulator, double* assetReturns, double* benchmarkReturns, int count);
+
+// Remove the oldest observation. Returns 1 if one was removed, 0 if empty.
+int RemoveOldestRiskObservation(RiskAccumulator* accumulator);
+
+// Read the current metrics
+void QueryRiskAccumulator(RiskAccumulator* accumulator, StreamingRiskMetrics* metrics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RISK_ACCUMULATOR_H
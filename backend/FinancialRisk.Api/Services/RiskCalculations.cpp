@@ -1,27 +1,304 @@
+#include "RiskCalculations.h"
+#include "MomentKernels.h"
+#include "ThreadPool.h"
+#include "QuantileKernels.h"
 #include <vector>
 #include <algorithm>
 #include <numeric>
 #include <cmath>
 #include <stdexcept>
+#include <type_traits>
+
+namespace {
+    // Non-tail metrics produced by the fused series kernel
+    struct FusedMetrics {
+        double volatility = 0.0;
+        double beta = 0.0;
+        double sharpeRatio = 0.0;
+        double sortinoRatio = 0.0;
+        double maximumDrawdown = 0.0;
+        double informationRatio = 0.0;
+    };
+    
+    // Fused single-series kernel shared by CalculateRiskProfile and the batch API.
+    // One pass reads the series (with the given stride) and the optional benchmark,
+    // accumulating shifted sums, co-moments and drawdown while copying the series
+    // into scratch. The copy is then partitioned with nested nth_element calls, one
+    // per confidence level; the tail sums come from its prefix and a final pass
+    // yields the downside deviation. scratch must hold length doubles.
+    void fusedSeriesMetrics(const double* asset, int assetStride, const double* benchmark, int length,
+                            double riskFreeRate, const double* confidenceLevels, int numLevels,
+                            double* scratch, FusedMetrics& metrics,
+                            double* valueAtRisk, double* expectedShortfall) {
+        metrics = FusedMetrics{};
+        for (int level = 0; level < numLevels; ++level) {
+            valueAtRisk[level] = 0.0;
+            expectedShortfall[level] = 0.0;
+        }
+        if (length < 2) return;
+        
+        // Shifting by the first observation keeps the one-pass variance well conditioned
+        const bool hasBenchmark = benchmark != nullptr;
+        const double assetShift = asset[0];
+        const double benchmarkShift = hasBenchmark ? benchmark[0] : 0.0;
+        const double excessShift = assetShift - benchmarkShift;
+        
+        double assetSum = 0.0, assetSumSq = 0.0;
+        double benchmarkSum = 0.0, benchmarkSumSq = 0.0, crossSum = 0.0;
+        double excessSum = 0.0, excessSumSq = 0.0;
+        double peak = 0.0, cumulative = 0.0, maxDrawdown = 0.0;
+        
+        for (int i = 0; i < length; ++i) {
+            double value = asset[static_cast<long long>(i) * assetStride];
+            scratch[i] = value;
+            
+            double assetDiff = value - assetShift;
+            assetSum += assetDiff;
+            assetSumSq += assetDiff * assetDiff;
+            
+            if (hasBenchmark) {
+                double benchmarkValue = benchmark[i];
+                double benchmarkDiff = benchmarkValue - benchmarkShift;
+                double excessDiff = (value - benchmarkValue) - excessShift;
+                benchmarkSum += benchmarkDiff;
+                benchmarkSumSq += benchmarkDiff * benchmarkDiff;
+                crossSum += assetDiff * benchmarkDiff;
+                excessSum += excessDiff;
+                excessSumSq += excessDiff * excessDiff;
+            }
+            
+            cumulative += value;
+            if (cumulative > peak) peak = cumulative;
+            if (peak - cumulative > maxDrawdown) maxDrawdown = peak - cumulative;
+        }
+        
+        const double n = static_cast<double>(length);
+        const double mean = assetShift + assetSum / n;
+        const double variance = std::max(0.0, (assetSumSq - assetSum * assetSum / n) / (n - 1));
+        const double volatility = std::sqrt(variance * 252.0);
+        
+        metrics.volatility = volatility;
+        metrics.maximumDrawdown = maxDrawdown;
+        if (volatility != 0.0) {
+            metrics.sharpeRatio = (mean * 252.0 - riskFreeRate) / volatility;
+        }
+        
+        if (hasBenchmark) {
+            double covariance = crossSum - assetSum * benchmarkSum / n;
+            double benchmarkVariance = benchmarkSumSq - benchmarkSum * benchmarkSum / n;
+            if (benchmarkVariance > 0.0) {
+                metrics.beta = covariance / benchmarkVariance;
+            }
+            
+            double excessMean = excessShift + excessSum / n;
+            double excessVariance = std::max(0.0, (excessSumSq - excessSum * excessSum / n) / (n - 1));
+            double trackingError = std::sqrt(excessVariance) * std::sqrt(252.0);
+            if (trackingError != 0.0) {
+                metrics.informationRatio = excessMean * 252.0 / trackingError;
+            }
+        }
+        
+        // Nested selection of every VaR level, then ES from prefix sums of the partitioned copy
+        int maxTail = RiskKernels::selectVaRLevels(scratch, length, confidenceLevels, numLevels, valueAtRisk);
+        RiskKernels::tailAveragesOfLevels(scratch, length, confidenceLevels, numLevels, maxTail, expectedShortfall);
+        
+        // Downside deviation from one pass over the copy
+        double downsideSum = 0.0;
+        int downsideCount = 0;
+        for (int i = 0; i < length; ++i) {
+            double value = scratch[i];
+            if (value < mean) {
+                double diff = value - mean;
+                downsideSum += diff * diff;
+                downsideCount++;
+            }
+        }
+        
+        if (downsideCount > 0) {
+            double downsideDeviation = std::sqrt(downsideSum / downsideCount * 252.0);
+            if (downsideDeviation != 0.0) {
+                metrics.sortinoRatio = (mean * 252.0 - riskFreeRate) / downsideDeviation;
+            }
+        }
+    }
+    
+    // Shared body of CalculateBatchRiskMetrics and its float variant. Float
+    // input is widened to double as it is gathered, so all accumulation and
+    // selection runs on doubles.
+    template <typename Real>
+    void batchRiskMetrics(const Real* returns, int numObservations, int numAssets, int stride, int layout,
+                          double riskFreeRate, double confidenceLevel,
+                          double* volatility, double* sharpeRatio, double* sortinoRatio,
+                          double* valueAtRisk, double* expectedShortfall, double* maximumDrawdown) {
+        if (returns == nullptr || numAssets <= 0) return;
+        constexpr bool inputIsDouble = std::is_same<Real, double>::value;
+        const bool rowMajor = layout == RISK_LAYOUT_ROW_MAJOR;
+        if (stride <= 0) stride = rowMajor ? numAssets : numObservations;
+        
+        // Row-major columns are gathered a cache line's worth of assets at a time
+        const int blockAssets = 8;
+        
+        RiskKernels::parallelFor(numAssets, blockAssets, [&](int begin, int end) {
+            thread_local std::vector<double> scratch;
+            thread_local std::vector<double> block;
+            scratch.resize(std::max(numObservations, 1));
+            if (rowMajor || !inputIsDouble) {
+                block.resize(static_cast<size_t>(std::max(numObservations, 1)) * blockAssets);
+            }
+            
+            for (int blockStart = begin; blockStart < end; blockStart += blockAssets) {
+                int blockEnd = std::min(end, blockStart + blockAssets);
+                if (rowMajor) {
+                    // One sequential pass over the rows transposes the block of columns
+                    for (int t = 0; t < numObservations; ++t) {
+                        const Real* row = returns + static_cast<long long>(t) * stride;
+                        for (int asset = blockStart; asset < blockEnd; ++asset) {
+                            block[static_cast<size_t>(asset - blockStart) * numObservations + t] = row[asset];
+                        }
+                    }
+                } else if constexpr (!inputIsDouble) {
+                    // Float columns are widened to double once per block
+                    for (int asset = blockStart; asset < blockEnd; ++asset) {
+                        const Real* column = returns + static_cast<long long>(asset) * stride;
+                        std::copy(column, column + numObservations,
+                                  block.begin() + static_cast<size_t>(asset - blockStart) * numObservations);
+                    }
+                }
+                
+                for (int asset = blockStart; asset < blockEnd; ++asset) {
+                    const double* series = block.data() + static_cast<size_t>(asset - blockStart) * numObservations;
+                    if constexpr (inputIsDouble) {
+                        if (!rowMajor) series = returns + static_cast<long long>(asset) * stride;
+                    }
+                    
+                    FusedMetrics metrics;
+                    double var = 0.0, es = 0.0;
+                    fusedSeriesMetrics(series, 1, nullptr, numObservations, riskFreeRate, &confidenceLevel, 1,
+                                       scratch.data(), metrics, &var, &es);
+                    
+                    if (volatility) volatility[asset] = metrics.volatility;
+                    if (sharpeRatio) sharpeRatio[asset] = metrics.sharpeRatio;
+                    if (sortinoRatio) sortinoRatio[asset] = metrics.sortinoRatio;
+                    if (valueAtRisk) valueAtRisk[asset] = var;
+                    if (expectedShortfall) expectedShortfall[asset] = es;
+                    if (maximumDrawdown) maximumDrawdown[asset] = metrics.maximumDrawdown;
+                }
+            }
+        });
+    }
+    
+    // Shared body of CalculateBenchmarkRelativeMetrics and its float variant;
+    // float values are converted as they are loaded and summed in double
+    template <typename Real>
+    void benchmarkRelativeMetrics(const Real* benchmarkReturns, const Real* returns, int numObservations,
+                                  int numAssets, int stride, int layout, double riskFreeRate,
+                                  double* beta, double* correlation, double* trackingError,
+                                  double* informationRatio, double* alpha) {
+        if (benchmarkReturns == nullptr || returns == nullptr || numAssets <= 0) return;
+        const bool rowMajor = layout == RISK_LAYOUT_ROW_MAJOR;
+        if (stride <= 0) stride = rowMajor ? numAssets : numObservations;
+        
+        auto writeZeros = [&](int asset) {
+            for (double* output : {beta, correlation, trackingError, informationRatio, alpha}) {
+                if (output) output[asset] = 0.0;
+            }
+        };
+        if (numObservations < 2) {
+            for (int asset = 0; asset < numAssets; ++asset) writeZeros(asset);
+            return;
+        }
+        
+        // Benchmark work done once: mean, centered series and sum of squares.
+        // With a centered benchmark, sum((a - meanA) * bc) == sum(a * bc), so each
+        // asset needs only sum(a), sum((a - a0)^2) and sum(a * bc) from one pass.
+        const double n = static_cast<double>(numObservations);
+        const RiskKernels::MomentKernels& kernels = RiskKernels::activeMomentKernels();
+        std::vector<double> centered(benchmarkReturns, benchmarkReturns + numObservations);
+        const double benchmarkMean = kernels.sum(centered.data(), numObservations) / n;
+        const double benchmarkSumSq = kernels.sumSquaredDeviations(centered.data(), numObservations, benchmarkMean);
+        for (int t = 0; t < numObservations; ++t) {
+            centered[t] -= benchmarkMean;
+        }
+        
+        auto finish = [&](int asset, double assetShift, double shiftedSum, double shiftedSumSq, double crossSum) {
+            double assetMean = assetShift + shiftedSum / n;
+            double assetSumSq = std::max(0.0, shiftedSumSq - shiftedSum * shiftedSum / n);
+            double excessSumSq = std::max(0.0, assetSumSq + benchmarkSumSq - 2.0 * crossSum);
+            double assetBeta = benchmarkSumSq > 0.0 ? crossSum / benchmarkSumSq : 0.0;
+            double denominator = std::sqrt(assetSumSq * benchmarkSumSq);
+            double te = std::sqrt(excessSumSq / (n - 1)) * std::sqrt(252.0);
+            
+            if (beta) beta[asset] = assetBeta;
+            if (correlation) correlation[asset] = denominator > 0.0 ? crossSum / denominator : 0.0;
+            if (trackingError) trackingError[asset] = te;
+            if (informationRatio) {
+                informationRatio[asset] = te != 0.0 ? (assetMean - benchmarkMean) * 252.0 / te : 0.0;
+            }
+            if (alpha) {
+                // Annualized Jensen's alpha
+                alpha[asset] = (assetMean * 252.0 - riskFreeRate) - assetBeta * (benchmarkMean * 252.0 - riskFreeRate);
+            }
+        };
+        
+        // Row-major: a block of adjacent assets is updated per row so the inner
+        // loop runs over contiguous memory and vectorizes
+        const int blockAssets = 64;
+        
+        RiskKernels::parallelFor(numAssets, blockAssets, [&](int begin, int end) {
+            if (rowMajor) {
+                double shift[blockAssets], sum[blockAssets], sumSq[blockAssets], cross[blockAssets];
+                for (int blockStart = begin; blockStart < end; blockStart += blockAssets) {
+                    const int width = std::min(end, blockStart + blockAssets) - blockStart;
+                    const Real* first = returns + blockStart;
+                    for (int k = 0; k < width; ++k) {
+                        shift[k] = first[k];
+                        sum[k] = sumSq[k] = cross[k] = 0.0;
+                    }
+                    for (int t = 0; t < numObservations; ++t) {
+                        const Real* row = returns + static_cast<long long>(t) * stride + blockStart;
+                        const double bc = centered[t];
+                        for (int k = 0; k < width; ++k) {
+                            double value = row[k];
+                            double diff = value - shift[k];
+                            sum[k] += diff;
+                            sumSq[k] += diff * diff;
+                            cross[k] += value * bc;
+                        }
+                    }
+                    for (int k = 0; k < width; ++k) {
+                        finish(blockStart + k, shift[k], sum[k], sumSq[k], cross[k]);
+                    }
+                }
+            } else {
+                for (int asset = begin; asset < end; ++asset) {
+                    const Real* series = returns + static_cast<long long>(asset) * stride;
+                    const double assetShift = series[0];
+                    double sum = 0.0, sumSq = 0.0, cross = 0.0;
+                    for (int t = 0; t < numObservations; ++t) {
+                        double value = series[t];
+                        double diff = value - assetShift;
+                        sum += diff;
+                        sumSq += diff * diff;
+                        cross += value * centered[t];
+                    }
+                    finish(asset, assetShift, sum, sumSq, cross);
+                }
+            }
+        });
+    }
+}
 
 extern "C" {
     // Calculate daily volatility (annualized)
     double CalculateVolatility(double* returns, int length) {
         if (length < 2) return 0.0;
+        const RiskKernels::MomentKernels& kernels = RiskKernels::activeMomentKernels();
         
         // Calculate mean return
-        double sum = 0.0;
-        for (int i = 0; i < length; ++i) {
-            sum += returns[i];
-        }
-        double mean = sum / length;
+        double mean = kernels.sum(returns, length) / length;
         
         // Calculate variance
-        double variance = 0.0;
-        for (int i = 0; i < length; ++i) {
-            double diff = returns[i] - mean;
-            variance += diff * diff;
-        }
+        double variance = kernels.sumSquaredDeviations(returns, length, mean);
         variance /= (length - 1); // Sample variance
         
         // Return annualized volatility (assuming daily returns)
@@ -31,24 +308,18 @@ extern "C" {
     // Calculate beta vs benchmark
     double CalculateBeta(double* assetReturns, double* benchmarkReturns, int length) {
         if (length < 2) return 0.0;
+        const RiskKernels::MomentKernels& kernels = RiskKernels::activeMomentKernels();
         
         // Calculate means
         double assetSum = 0.0, benchmarkSum = 0.0;
-        for (int i = 0; i < length; ++i) {
-            assetSum += assetReturns[i];
-            benchmarkSum += benchmarkReturns[i];
-        }
+        kernels.sumPair(assetReturns, benchmarkReturns, length, &assetSum, &benchmarkSum);
         double assetMean = assetSum / length;
         double benchmarkMean = benchmarkSum / length;
         
         // Calculate covariance and benchmark variance
         double covariance = 0.0, benchmarkVariance = 0.0;
-        for (int i = 0; i < length; ++i) {
-            double assetDiff = assetReturns[i] - assetMean;
-            double benchmarkDiff = benchmarkReturns[i] - benchmarkMean;
-            covariance += assetDiff * benchmarkDiff;
-            benchmarkVariance += benchmarkDiff * benchmarkDiff;
-        }
+        kernels.coMoments(assetReturns, benchmarkReturns, length, assetMean, benchmarkMean,
+                          &covariance, &benchmarkVariance);
         
         if (benchmarkVariance == 0.0) return 0.0;
         return covariance / benchmarkVariance;
@@ -119,37 +390,20 @@ extern "C" {
     double CalculateValueAtRisk(double* returns, double confidenceLevel, int length) {
         if (length < 2) return 0.0;
         
-        // Create a copy of returns for sorting
-        std::vector<double> sortedReturns(returns, returns + length);
-        std::sort(sortedReturns.begin(), sortedReturns.end());
-        
-        // Calculate the index for the confidence level
-        int index = static_cast<int>((1.0 - confidenceLevel) * length);
-        if (index >= length) index = length - 1;
-        if (index < 0) index = 0;
+        // Select the order statistic for the confidence level; no full sort needed
+        int index = RiskKernels::historicalVaRIndex(confidenceLevel, length);
         
         // Return negative VaR (loss)
-        return -sortedReturns[index];
+        return -RiskKernels::selectOrderStatistic(returns, length, index);
     }
     
     // Calculate Expected Shortfall (Conditional VaR)
     double CalculateExpectedShortfall(double* returns, double confidenceLevel, int length) {
         if (length < 2) return 0.0;
         
-        // Create a copy of returns for sorting
-        std::vector<double> sortedReturns(returns, returns + length);
-        std::sort(sortedReturns.begin(), sortedReturns.end());
-        
-        // Calculate the number of observations in the tail
-        int tailCount = static_cast<int>((1.0 - confidenceLevel) * length);
-        if (tailCount <= 0) tailCount = 1;
-        if (tailCount > length) tailCount = length;
-        
-        // Calculate average of the worst returns
-        double tailSum = 0.0;
-        for (int i = 0; i < tailCount; ++i) {
-            tailSum += sortedReturns[i];
-        }
+        // Average of the worst returns, found by partitioning rather than sorting
+        int tailCount = RiskKernels::historicalTailCount(confidenceLevel, length);
+        double tailSum = RiskKernels::sumSmallest(returns, length, tailCount);
         
         // Return negative expected shortfall (average loss)
         return -(tailSum / tailCount);
@@ -180,20 +434,13 @@ extern "C" {
     // Calculate Information Ratio
     double CalculateInformationRatio(double* assetReturns, double* benchmarkReturns, int length) {
         if (length < 2) return 0.0;
+        const RiskKernels::MomentKernels& kernels = RiskKernels::activeMomentKernels();
         
         // Calculate tracking error (standard deviation of excess returns)
-        double excessSum = 0.0;
-        for (int i = 0; i < length; ++i) {
-            excessSum += (assetReturns[i] - benchmarkReturns[i]);
-        }
+        double excessSum = kernels.sumDifference(assetReturns, benchmarkReturns, length);
         double excessMean = excessSum / length;
         
-        double trackingErrorSum = 0.0;
-        for (int i = 0; i < length; ++i) {
-            double excess = assetReturns[i] - benchmarkReturns[i];
-            double diff = excess - excessMean;
-            trackingErrorSum += diff * diff;
-        }
+        double trackingErrorSum = kernels.sumSquaredDifferenceDeviations(assetReturns, benchmarkReturns, length, excessMean);
         double trackingError = std::sqrt(trackingErrorSum / (length - 1)) * std::sqrt(252.0);
         
         if (trackingError == 0.0) return 0.0;
@@ -202,4 +449,76 @@ extern "C" {
         double annualizedExcess = excessMean * 252.0;
         return annualizedExcess / trackingError;
     }
+    
+    // Calculate all risk metrics in one fused pass plus one shared selection step
+    void CalculateRiskProfile(double* assetReturns, double* benchmarkReturns, double riskFreeRate,
+                              int length, RiskProfile* profile) {
+        if (profile == nullptr) return;
+        *profile = RiskProfile{};
+        if (length < 2 || assetReturns == nullptr) return;
+        
+        const double confidenceLevels[2] = {0.95, 0.99};
+        double valueAtRisk[2], expectedShortfall[2];
+        std::vector<double> scratch(length);
+        FusedMetrics metrics;
+        fusedSeriesMetrics(assetReturns, 1, benchmarkReturns, length, riskFreeRate, confidenceLevels, 2,
+                           scratch.data(), metrics, valueAtRisk, expectedShortfall);
+        
+        profile->volatility = metrics.volatility;
+        profile->beta = metrics.beta;
+        profile->sharpeRatio = metrics.sharpeRatio;
+        profile->sortinoRatio = metrics.sortinoRatio;
+        profile->valueAtRisk95 = valueAtRisk[0];
+        profile->valueAtRisk99 = valueAtRisk[1];
+        profile->expectedShortfall95 = expectedShortfall[0];
+        profile->expectedShortfall99 = expectedShortfall[1];
+        profile->maximumDrawdown = metrics.maximumDrawdown;
+        profile->informationRatio = metrics.informationRatio;
+    }
+    
+    // Calculate per-asset metrics for every column of a returns matrix in parallel
+    void CalculateBatchRiskMetrics(double* returns, int numObservations, int numAssets, int stride, int layout,
+                                   double riskFreeRate, double confidenceLevel,
+                                   double* volatility, double* sharpeRatio, double* sortinoRatio,
+                                   double* valueAtRisk, double* expectedShortfall, double* maximumDrawdown) {
+        batchRiskMetrics(returns, numObservations, numAssets, stride, layout, riskFreeRate, confidenceLevel,
+                         volatility, sharpeRatio, sortinoRatio, valueAtRisk, expectedShortfall, maximumDrawdown);
+    }
+    
+    // Float32 storage variant of CalculateBatchRiskMetrics
+    void CalculateBatchRiskMetricsFloat(float* returns, int numObservations, int numAssets, int stride, int layout,
+                                        double riskFreeRate, double confidenceLevel,
+                                        double* volatility, double* sharpeRatio, double* sortinoRatio,
+                                        double* valueAtRisk, double* expectedShortfall, double* maximumDrawdown) {
+        batchRiskMetrics(returns, numObservations, numAssets, stride, layout, riskFreeRate, confidenceLevel,
+                         volatility, sharpeRatio, sortinoRatio, valueAtRisk, expectedShortfall, maximumDrawdown);
+    }
+    
+    // Calculate benchmark-relative metrics for many assets against one shared benchmark
+    void CalculateBenchmarkRelativeMetrics(double* benchmarkReturns, double* returns, int numObservations,
+                                           int numAssets, int stride, int layout, double riskFreeRate,
+                                           double* beta, double* correlation, double* trackingError,
+                                           double* informationRatio, double* alpha) {
+        benchmarkRelativeMetrics(benchmarkReturns, returns, numObservations, numAssets, stride, layout,
+                                 riskFreeRate, beta, correlation, trackingError, informationRatio, alpha);
+    }
+    
+    // Float32 storage variant of CalculateBenchmarkRelativeMetrics
+    void CalculateBenchmarkRelativeMetricsFloat(float* benchmarkReturns, float* returns, int numObservations,
+                                                int numAssets, int stride, int layout, double riskFreeRate,
+                                                double* beta, double* correlation, double* trackingError,
+                                                double* informationRatio, double* alpha) {
+        benchmarkRelativeMetrics(benchmarkReturns, returns, numObservations, numAssets, stride, layout,
+                                 riskFreeRate, beta, correlation, trackingError, informationRatio, alpha);
+    }
+    
+    // Instruction set used by the moment kernels
+    int GetMomentKernelIsa() {
+        return static_cast<int>(RiskKernels::activeMomentKernelIsa());
+    }
+    
+    // Override the instruction set (unsupported requests keep the current one)
+    int SetMomentKernelIsa(int isa) {
+        return static_cast<int>(RiskKernels::selectMomentKernels(static_cast<RiskKernels::MomentKernelIsa>(isa)));
+    }
 }
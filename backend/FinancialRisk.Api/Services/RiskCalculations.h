@@ -5,6 +5,28 @@
 extern "C" {
 #endif
 
+// Full set of single-asset risk metrics produced by CalculateRiskProfile.
+// Field order mirrors the RiskMetrics model so it can be marshalled as a
+// sequential struct from C#.
+typedef struct RiskProfile {
+    double volatility;
+    double beta;
+    double sharpeRatio;
+    double sortinoRatio;
+    double valueAtRisk95;
+    double valueAtRisk99;
+    double expectedShortfall95;
+    double expectedShortfall99;
+    double maximumDrawdown;
+    double informationRatio;
+} RiskProfile;
+
+// Layout of the returns matrices accepted by the batch functions.
+// Row-major: observation t of asset j is at returns[t * stride + j].
+// Column-major: observation t of asset j is at returns[j * stride + t].
+#define RISK_LAYOUT_ROW_MAJOR 0
+#define RISK_LAYOUT_COLUMN_MAJOR 1
+
 // Calculate daily volatility (annualized)
 double CalculateVolatility(double* returns, int length);
 
@@ -29,6 +51,67 @@ double CalculateMaximumDrawdown(double* returns, int length);
 // Calculate Information Ratio
 double CalculateInformationRatio(double* assetReturns, double* benchmarkReturns, int length);
 
+// Calculate every metric above in one call: a single fused pass over the
+// inputs plus one shared order-statistic step for the 95%/99% VaR and ES.
+// benchmarkReturns may be null, in which case beta and information ratio are 0.
+void CalculateRiskProfile(double* assetReturns, double* benchmarkReturns, double riskFreeRate,
+                          int length, RiskProfile* profile);
+
+// Calculate volatility, Sharpe, Sortino, VaR, ES and maximum drawdown for each
+// of numAssets series in a numObservations x numAssets returns matrix, split
+// across a thread pool. stride <= 0 means densely packed. Any output array may
+// be null to skip that metric; the others receive numAssets values.
+void CalculateBatchRiskMetrics(double* returns, int numObservations, int numAssets, int stride, int layout,
+                               double riskFreeRate, double confidenceLevel,
+                               double* volatility, double* sharpeRatio, double* sortinoRatio,
+                               double* valueAtRisk, double* expectedShortfall, double* maximumDrawdown);
+
+// Float32 storage variants of the two batch kernels, for matrices that do not
+// fit in cache as doubles. Each value is widened to double when it is loaded,
+// and every sum, moment and tail average is accumulated in double. The only
+// difference from running the double entry point on the same (float) data is
+// the order of a few double additions, so results agree to ~1e-12 relative.
+// Against the original unrounded doubles, the error is the input rounding
+// alone: each return moves by at most 2^-24 (~6e-8) relative. That is an
+// absolute bound of about 2^-24 mean|r| on means, independent of
+// numObservations; a mean near zero (as daily means often are) can have any
+// relative error, and so can betas and ratios near zero. Volatilities keep a
+// relative error of ~2^-24, and VaR/ES move by at most one float ulp.
+void CalculateBatchRiskMetricsFloat(float* returns, int numObservations, int numAssets, int stride, int layout,
+                                    double riskFreeRate, double confidenceLevel,
+                                    double* volatility, double* sharpeRatio, double* sortinoRatio,
+                                    double* valueAtRisk, double* expectedShortfall, double* maximumDrawdown);
+
+// Calculate beta, correlation, tracking error, information ratio and
+// annualized Jensen's alpha for numAssets series against one shared benchmark.
+// The benchmark is centered once and every asset then needs a single blocked
+// pass over the matrix; assets are split across a thread pool. The returns
+// matrix uses the same layout/stride convention as CalculateBatchRiskMetrics.
+// Any output array may be null.
+void CalculateBenchmarkRelativeMetrics(double* benchmarkReturns, double* returns, int numObservations,
+                                       int numAssets, int stride, int layout, double riskFreeRate,
+                                       double* beta, double* correlation, double* trackingError,
+                                       double* informationRatio, double* alpha);
+
+// Float32 storage variant of CalculateBenchmarkRelativeMetrics, accumulated in
+// double as CalculateBatchRiskMetricsFloat. Input rounding gives beta, alpha
+// and correlation an absolute error of order 2^-24 times the scale of the
+// returns involved (e.g. mean|r_asset (r_benchmark - mean)| / variance for
+// beta), so their relative error is unbounded near zero, as for means.
+void CalculateBenchmarkRelativeMetricsFloat(float* benchmarkReturns, float* returns, int numObservations,
+                                            int numAssets, int stride, int layout, double riskFreeRate,
+                                            double* beta, double* correlation, double* trackingError,
+                                            double* informationRatio, double* alpha);
+
+// Instruction set used by the volatility/beta/information ratio kernels:
+// 0 = scalar, 1 = AVX2, 2 = AVX-512. The best supported one is chosen when
+// the library is loaded.
+int GetMomentKernelIsa(void);
+
+// Force a specific instruction set (e.g. 0 for the scalar reference path).
+// Returns the instruction set in use afterwards; unsupported requests are ignored.
+int SetMomentKernelIsa(int isa);
+
 #ifdef __cplusplus
 }
 #endif
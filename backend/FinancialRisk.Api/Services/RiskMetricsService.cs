@@ -36,6 +36,26 @@ namespace FinancialRisk.Api.Services
         [DllImport("RiskCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
         private static extern double CalculateExpectedShortfall(double[] returns, double confidenceLevel, int length);
 
+        [DllImport("RiskCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateRiskProfile(double[] assetReturns, double[]? benchmarkReturns, double riskFreeRate,
+            int length, out RiskProfile profile);
+
+        // Mirrors the native RiskProfile struct in RiskCalculations.h
+        [StructLayout(LayoutKind.Sequential)]
+        private struct RiskProfile
+        {
+            public double Volatility;
+            public double Beta;
+            public double SharpeRatio;
+            public double SortinoRatio;
+            public double ValueAtRisk95;
+            public double ValueAtRisk99;
+            public double ExpectedShortfall95;
+            public double ExpectedShortfall99;
+            public double MaximumDrawdown;
+            public double InformationRatio;
+        }
+
         public RiskMetricsService(
             ILogger<RiskMetricsService> logger,
             IFinancialDataService financialDataService,
@@ -68,31 +88,26 @@ namespace FinancialRisk.Api.Services
                     return new RiskMetrics { Symbol = symbol, Error = "Insufficient data for calculations" };
                 }
 
-                // Calculate risk metrics using C++ library
-                var volatility = CalculateVolatility(returns, returns.Length);
-                var sharpeRatio = CalculateSharpeRatio(returns, 0.02, returns.Length); // 2% risk-free rate
-                var sortinoRatio = CalculateSortinoRatio(returns, 0.02, returns.Length);
-                var var95 = CalculateValueAtRisk(returns, 0.95, returns.Length);
-                var var99 = CalculateValueAtRisk(returns, 0.99, returns.Length);
-                var expectedShortfall95 = CalculateExpectedShortfall(returns, 0.95, returns.Length);
-                var expectedShortfall99 = CalculateExpectedShortfall(returns, 0.99, returns.Length);
+                // Calculate risk metrics using C++ library (single native call)
+                CalculateRiskProfile(returns, null, 0.02, returns.Length, out var profile); // 2% risk-free rate
 
                 var riskMetrics = new RiskMetrics
                 {
                     Symbol = symbol,
-                    Volatility = volatility,
-                    SharpeRatio = sharpeRatio,
-                    SortinoRatio = sortinoRatio,
-                    ValueAtRisk95 = var95,
-                    ValueAtRisk99 = var99,
-                    ExpectedShortfall95 = expectedShortfall95,
-                    ExpectedShortfall99 = expectedShortfall99,
+                    Volatility = profile.Volatility,
+                    SharpeRatio = profile.SharpeRatio,
+                    SortinoRatio = profile.SortinoRatio,
+                    ValueAtRisk95 = profile.ValueAtRisk95,
+                    ValueAtRisk99 = profile.ValueAtRisk99,
+                    ExpectedShortfall95 = profile.ExpectedShortfall95,
+                    ExpectedShortfall99 = profile.ExpectedShortfall99,
+                    MaximumDrawdown = profile.MaximumDrawdown,
                     CalculationDate = DateTime.UtcNow,
                     DataPoints = returns.Length
                 };
 
                 _logger.LogInformation("Successfully calculated risk metrics for {Symbol}: Volatility={Volatility:F4}, Sharpe={Sharpe:F4}", 
-                    symbol, volatility, sharpeRatio);
+                    symbol, profile.Volatility, profile.SharpeRatio);
 
                 return riskMetrics;
             }
@@ -139,27 +154,26 @@ namespace FinancialRisk.Api.Services
                 var portfolioReturns = CalculatePortfolioReturns(assetData, weights);
 
                 // Calculate portfolio risk metrics
-                var portfolioVolatility = CalculateVolatility(portfolioReturns, portfolioReturns.Length);
-                var portfolioSharpe = CalculateSharpeRatio(portfolioReturns, 0.02, portfolioReturns.Length);
-                var portfolioSortino = CalculateSortinoRatio(portfolioReturns, 0.02, portfolioReturns.Length);
-                var portfolioVar95 = CalculateValueAtRisk(portfolioReturns, 0.95, portfolioReturns.Length);
-                var portfolioVar99 = CalculateValueAtRisk(portfolioReturns, 0.99, portfolioReturns.Length);
+                CalculateRiskProfile(portfolioReturns, null, 0.02, portfolioReturns.Length, out var profile);
 
                 var portfolioMetrics = new PortfolioRiskMetrics
                 {
                     Symbols = symbols,
                     Weights = weights,
-                    Volatility = portfolioVolatility,
-                    SharpeRatio = portfolioSharpe,
-                    SortinoRatio = portfolioSortino,
-                    ValueAtRisk95 = portfolioVar95,
-                    ValueAtRisk99 = portfolioVar99,
+                    Volatility = profile.Volatility,
+                    SharpeRatio = profile.SharpeRatio,
+                    SortinoRatio = profile.SortinoRatio,
+                    ValueAtRisk95 = profile.ValueAtRisk95,
+                    ValueAtRisk99 = profile.ValueAtRisk99,
+                    ExpectedShortfall95 = profile.ExpectedShortfall95,
+                    ExpectedShortfall99 = profile.ExpectedShortfall99,
+                    MaximumDrawdown = profile.MaximumDrawdown,
                     CalculationDate = DateTime.UtcNow,
                     DataPoints = portfolioReturns.Length
                 };
 
                 _logger.LogInformation("Successfully calculated portfolio risk metrics: Volatility={Volatility:F4}, Sharpe={Sharpe:F4}", 
-                    portfolioVolatility, portfolioSharpe);
+                    profile.Volatility, profile.SharpeRatio);
 
                 return portfolioMetrics;
             }
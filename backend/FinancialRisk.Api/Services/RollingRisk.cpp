@@ -0,0 +1,130 @@
+#include "RollingRisk.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Sliding sums of shifted returns for one window length. Sums are taken
+    // relative to the window mean at the last re-anchor, which keeps the
+    // one-pass variance formulas well conditioned.
+    struct WindowState {
+        int window = 0;
+        long long offset = 0;      // row offset into the output arrays
+        double shiftAsset = 0.0;
+        double shiftBenchmark = 0.0;
+        double sumA = 0.0, sumAA = 0.0;
+        double sumB = 0.0, sumBB = 0.0, sumAB = 0.0;
+    };
+    
+    // Recompute the sums exactly over (end - window, end]
+    void reanchor(WindowState& state, const double* asset, const double* benchmark, int end) {
+        const int begin = end - state.window + 1;
+        double meanAsset = 0.0, meanBenchmark = 0.0;
+        for (int i = begin; i <= end; ++i) {
+            meanAsset += asset[i];
+            if (benchmark) meanBenchmark += benchmark[i];
+        }
+        state.shiftAsset = meanAsset / state.window;
+        state.shiftBenchmark = meanBenchmark / state.window;
+        
+        state.sumA = state.sumAA = state.sumB = state.sumBB = state.sumAB = 0.0;
+        for (int i = begin; i <= end; ++i) {
+            double da = asset[i] - state.shiftAsset;
+            state.sumA += da;
+            state.sumAA += da * da;
+            if (benchmark) {
+                double db = benchmark[i] - state.shiftBenchmark;
+                state.sumB += db;
+                state.sumBB += db * db;
+                state.sumAB += da * db;
+            }
+        }
+    }
+    
+    // Add observation i and drop observation i - window
+    void slide(WindowState& state, const double* asset, const double* benchmark, int i) {
+        double daIn = asset[i] - state.shiftAsset;
+        double daOut = asset[i - state.window] - state.shiftAsset;
+        state.sumA += daIn - daOut;
+        state.sumAA += daIn * daIn - daOut * daOut;
+        if (benchmark) {
+            double dbIn = benchmark[i] - state.shiftBenchmark;
+            double dbOut = benchmark[i - state.window] - state.shiftBenchmark;
+            state.sumB += dbIn - dbOut;
+            state.sumBB += dbIn * dbIn - dbOut * dbOut;
+            state.sumAB += daIn * dbIn - daOut * dbOut;
+        }
+    }
+}
+
+extern "C" {
+    // Calculate rolling risk metrics for several window lengths in one pass
+    void CalculateRollingRiskMetrics(double* assetReturns, double* benchmarkReturns, int length,
+                                     int* windowLengths, int numWindows, double riskFreeRate,
+                                     double* volatility, double* beta, double* sharpeRatio,
+                                     double* informationRatio) {
+        if (assetReturns == nullptr || windowLengths == nullptr || length <= 0 || numWindows <= 0) return;
+        if (benchmarkReturns == nullptr) {
+            beta = nullptr;
+            informationRatio = nullptr;
+        }
+        
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const long long total = static_cast<long long>(numWindows) * length;
+        for (double* output : {volatility, beta, sharpeRatio, informationRatio}) {
+            if (output) std::fill(output, output + total, nan);
+        }
+        
+        std::vector<WindowState> states;
+        for (int w = 0; w < numWindows; ++w) {
+            // Windows that never fill (or cannot produce a sample variance) stay NaN
+            if (windowLengths[w] < 2 || windowLengths[w] > length) continue;
+            WindowState state;
+            state.window = windowLengths[w];
+            state.offset = static_cast<long long>(w) * length;
+            states.push_back(state);
+        }
+        
+        const double annualization = std::sqrt(252.0);
+        for (int t = 0; t < length; ++t) {
+            for (WindowState& state : states) {
+                const int filled = t - (state.window - 1);
+                if (filled < 0) continue;
+                
+                // Exact recomputation once per window length bounds the drift
+                // of the sliding sums while keeping the total cost O(length)
+                if (filled % state.window == 0) {
+                    reanchor(state, assetReturns, benchmarkReturns, t);
+                } else {
+                    slide(state, assetReturns, benchmarkReturns, t);
+                }
+                
+                const double n = state.window;
+                const double mean = state.shiftAsset + state.sumA / n;
+                const double variance = std::max(0.0, (state.sumAA - state.sumA * state.sumA / n) / (n - 1));
+                const double vol = std::sqrt(variance) * annualization;
+                const long long out = state.offset + t;
+                
+                if (volatility) volatility[out] = vol;
+                if (sharpeRatio) sharpeRatio[out] = vol > 0.0 ? (mean * 252.0 - riskFreeRate) / vol : 0.0;
+                
+                if (benchmarkReturns) {
+                    double covariance = state.sumAB - state.sumA * state.sumB / n;
+                    double benchmarkVariance = state.sumBB - state.sumB * state.sumB / n;
+                    if (beta) beta[out] = benchmarkVariance > 0.0 ? covariance / benchmarkVariance : 0.0;
+                    
+                    if (informationRatio) {
+                        // Excess returns a - b share the shifted sums: sum(da - db), sum((da - db)^2)
+                        double sumE = state.sumA - state.sumB;
+                        double sumEE = state.sumAA - 2.0 * state.sumAB + state.sumBB;
+                        double excessMean = (state.shiftAsset - state.shiftBenchmark) + sumE / n;
+                        double excessVariance = std::max(0.0, (sumEE - sumE * sumE / n) / (n - 1));
+                        double trackingError = std::sqrt(excessVariance) * annualization;
+                        informationRatio[out] = trackingError > 0.0 ? excessMean * 252.0 / trackingError : 0.0;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef ROLLING_RISK_H
+#define ROLLING_RISK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rolling volatility, beta, Sharpe ratio and information ratio for several
+// window lengths in one O(length) pass over the data, using sliding sums that
+// are re-anchored once per window length to limit floating-point drift.
+//
+// Each output array holds numWindows x length values: row w is the series for
+// windowLengths[w], and element t covers observations (t - window, t]. Elements
+// before the first full window are NaN. benchmarkReturns may be null, in which
+// case beta and informationRatio are not written. Any output may be null.
+void CalculateRollingRiskMetrics(double* assetReturns, double* benchmarkReturns, int length,
+                                 int* windowLengths, int numWindows, double riskFreeRate,
+                                 double* volatility, double* beta, double* sharpeRatio,
+                                 double* informationRatio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROLLING_RISK_H
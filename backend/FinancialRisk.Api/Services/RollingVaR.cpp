@@ -0,0 +1,51 @@
+#include "RollingVaR.h"
+#include "OrderStatisticTree.h"
+#include "QuantileKernels.h"
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+extern "C" {
+    // Rolling historical VaR/CVaR using an order-statistic window
+    void CalculateRollingHistoricalVaR(double* returns, int length, int windowLength,
+                                       double* confidenceLevels, int numLevels,
+                                       double* valueAtRisk, double* expectedShortfall) {
+        if (returns == nullptr || confidenceLevels == nullptr || length <= 0 || numLevels <= 0) return;
+        
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const long long total = static_cast<long long>(numLevels) * length;
+        if (valueAtRisk) std::fill(valueAtRisk, valueAtRisk + total, nan);
+        if (expectedShortfall) std::fill(expectedShortfall, expectedShortfall + total, nan);
+        if (windowLength < 2 || windowLength > length) return;
+        
+        // Order-statistic index and tail size are fixed for a fixed window
+        std::vector<int> indices(numLevels), tailCounts(numLevels);
+        std::vector<bool> valid(numLevels);
+        for (int level = 0; level < numLevels; ++level) {
+            double confidenceLevel = confidenceLevels[level];
+            valid[level] = confidenceLevel > 0.0 && confidenceLevel < 1.0;
+            indices[level] = RiskKernels::historicalVaRIndex(confidenceLevel, windowLength);
+            tailCounts[level] = RiskKernels::historicalTailCount(confidenceLevel, windowLength);
+        }
+        
+        RiskKernels::OrderStatisticTree window(returns, length);
+        for (int t = 0; t < length; ++t) {
+            window.insert(t);
+            if (t >= windowLength) window.remove(t - windowLength);
+            if (t < windowLength - 1) continue;
+            
+            for (int level = 0; level < numLevels; ++level) {
+                long long out = static_cast<long long>(level) * length + t;
+                if (!valid[level]) {
+                    if (valueAtRisk) valueAtRisk[out] = 0.0;
+                    if (expectedShortfall) expectedShortfall[out] = 0.0;
+                    continue;
+                }
+                if (valueAtRisk) valueAtRisk[out] = -window.kth(indices[level]);
+                if (expectedShortfall) {
+                    expectedShortfall[out] = -(window.sumSmallest(tailCounts[level]) / tailCounts[level]);
+                }
+            }
+        }
+    }
+}
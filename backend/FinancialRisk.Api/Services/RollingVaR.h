@@ -0,0 +1,26 @@
+#ifndef ROLLING_VAR_H
+#define ROLLING_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rolling historical VaR and CVaR (Expected Shortfall) over a sliding window,
+// for several confidence levels at once. The window is kept in an indexed
+// order-statistic structure, so each step costs O(log length) instead of a
+// copy and full sort per window.
+//
+// valueAtRisk and expectedShortfall hold numLevels x length values: row l is
+// the series for confidenceLevels[l], and element t covers observations
+// (t - windowLength, t]. Elements before the first full window are NaN.
+// Results match CalculateHistoricalVaR / CalculateHistoricalCVaR on each window.
+// Either output may be null.
+void CalculateRollingHistoricalVaR(double* returns, int length, int windowLength,
+                                   double* confidenceLevels, int numLevels,
+                                   double* valueAtRisk, double* expectedShortfall);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROLLING_VAR_H
@@ -0,0 +1,173 @@
+#include "SmoothedQuantileVaR.h"
+#include "QuantileKernels.h"
+#include "DistributionKernels.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace {
+    // Weights below this are dropped from both ends of a weight vector
+    const double NegligibleWeight = 1e-17;
+    // The cache is cleared when it reaches this many weight vectors
+    const size_t MaxCachedWeights = 256;
+    // Series handed to a worker at a time
+    const int AssetGrain = 4;
+    // Independent accumulators of the dot product
+    const int Lanes = 8;
+    
+    // Weights of order statistics [first, first + weights.size())
+    struct QuantileWeights {
+        int first = 0;
+        std::vector<double> weights;
+    };
+    
+    using WeightsPointer = std::shared_ptr<const QuantileWeights>;
+    
+    // Weight of the i-th order statistic (1-based) is cdf(i / n) - cdf((i - 1) / n)
+    template <typename Cdf>
+    std::vector<double> differencedWeights(int length, double start, Cdf cdf) {
+        std::vector<double> weights(length, 0.0);
+        double previous = start;
+        for (int i = 1; i <= length; ++i) {
+            const double current = cdf(static_cast<double>(i) / length);
+            weights[i - 1] = current - previous;
+            previous = current;
+            if (current >= 1.0) break;
+        }
+        return weights;
+    }
+    
+    QuantileWeights computeWeights(int estimator, int length, double confidenceLevel) {
+        QuantileWeights result;
+        if (estimator == QUANTILE_EMPIRICAL) {
+            result.first = RiskKernels::historicalVaRIndex(confidenceLevel, length);
+            result.weights.assign(1, 1.0);
+            return result;
+        }
+        
+        const double p = 1.0 - confidenceLevel;
+        std::vector<double> weights;
+        if (estimator == QUANTILE_HARRELL_DAVIS) {
+            const double a = p * (length + 1), b = (1.0 - p) * (length + 1);
+            weights = differencedWeights(length, 0.0, [&](double x) {
+                return x >= 1.0 ? 1.0 : RiskKernels::incompleteBeta(x, a, b);
+            });
+        } else {
+            // Gaussian kernel mass between (i - 1) / n and i / n, renormalized
+            // for the mass the kernel puts outside [0, 1]
+            const double bandwidth = std::sqrt(p * (1.0 - p) / length);
+            auto normalCdf = [&](double x) { return 0.5 * std::erfc(-(x - p) / (bandwidth * std::sqrt(2.0))); };
+            weights = differencedWeights(length, normalCdf(0.0), normalCdf);
+            const double mass = normalCdf(1.0) - normalCdf(0.0);
+            for (double& weight : weights) weight /= mass;
+        }
+        
+        int first = 0, last = length;
+        while (first < last && weights[first] < NegligibleWeight) ++first;
+        while (last > first && weights[last - 1] < NegligibleWeight) --last;
+        result.first = first;
+        result.weights.assign(weights.begin() + first, weights.begin() + last);
+        return result;
+    }
+    
+    // Cached weights of (estimator, length, confidenceLevel)
+    WeightsPointer cachedWeights(int estimator, int length, double confidenceLevel) {
+        static std::mutex mutex;
+        static std::map<std::tuple<int, int, double>, WeightsPointer> cache;
+        const auto key = std::make_tuple(estimator, length, confidenceLevel);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = cache.find(key);
+            if (found != cache.end()) return found->second;
+        }
+        WeightsPointer weights = std::make_shared<const QuantileWeights>(computeWeights(estimator, length, confidenceLevel));
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cache.size() >= MaxCachedWeights) cache.clear();
+        cache.emplace(key, weights);
+        return weights;
+    }
+    
+    // Weights of every level, null for invalid levels
+    std::vector<WeightsPointer> levelWeights(int length, const double* confidenceLevels, int numLevels, int estimator) {
+        std::vector<WeightsPointer> weights(numLevels);
+        if (length < 2) return weights;
+        if (estimator != QUANTILE_EMPIRICAL && estimator != QUANTILE_HARRELL_DAVIS && estimator != QUANTILE_KERNEL) {
+            return weights;
+        }
+        for (int level = 0; level < numLevels; ++level) {
+            if (confidenceLevels[level] > 0.0 && confidenceLevels[level] < 1.0) {
+                weights[level] = cachedWeights(estimator, length, confidenceLevels[level]);
+            }
+        }
+        return weights;
+    }
+    
+    double weightedSum(const double* weights, const double* values, int count) {
+        double lanes[Lanes] = {};
+        int i = 0;
+        for (; i + Lanes <= count; i += Lanes) {
+            for (int k = 0; k < Lanes; ++k) {
+                lanes[k] += weights[i + k] * values[i + k];
+            }
+        }
+        double total = 0.0;
+        for (; i < count; ++i) total += weights[i] * values[i];
+        for (int k = 0; k < Lanes; ++k) total += lanes[k];
+        return total;
+    }
+    
+    // Smoothed VaR of one series: only the order statistics under some
+    // level's weights are put in sorted position
+    void smoothedSeries(const double* returns, int length, const std::vector<WeightsPointer>& weights,
+                        double* valueAtRisk) {
+        const int numLevels = static_cast<int>(weights.size());
+        std::fill(valueAtRisk, valueAtRisk + numLevels, 0.0);
+        int lo = length, hi = 0;
+        for (const WeightsPointer& level : weights) {
+            if (!level) continue;
+            lo = std::min(lo, level->first);
+            hi = std::max(hi, level->first + static_cast<int>(level->weights.size()));
+        }
+        if (lo >= hi) return;
+        
+        double* work = RiskKernels::quantileScratch(returns, length);
+        if (lo > 0) std::nth_element(work, work + lo, work + length);
+        if (hi < length) std::nth_element(work + lo, work + hi, work + length);
+        std::sort(work + lo, work + hi);
+        for (int level = 0; level < numLevels; ++level) {
+            const WeightsPointer& levelWeight = weights[level];
+            if (!levelWeight) continue;
+            valueAtRisk[level] = -weightedSum(levelWeight->weights.data(), work + levelWeight->first,
+                                              static_cast<int>(levelWeight->weights.size()));
+        }
+    }
+}
+
+extern "C" {
+    // Harrell-Davis / kernel-smoothed historical VaR at several levels
+    void CalculateSmoothedHistoricalVaR(double* returns, int length, double* confidenceLevels, int numLevels,
+                                        int estimator, double* valueAtRisk) {
+        if (returns == nullptr || confidenceLevels == nullptr || valueAtRisk == nullptr || numLevels <= 0) return;
+        smoothedSeries(returns, length, levelWeights(length, confidenceLevels, numLevels, estimator), valueAtRisk);
+    }
+    
+    // Smoothed historical VaR for many series sharing the cached weights
+    void CalculateBatchSmoothedHistoricalVaR(double* assetReturns, int numAssets, int length,
+                                             double* confidenceLevels, int numLevels, int estimator,
+                                             double* valueAtRisk) {
+        if (assetReturns == nullptr || confidenceLevels == nullptr || valueAtRisk == nullptr) return;
+        if (numAssets <= 0 || numLevels <= 0) return;
+        const std::vector<WeightsPointer> weights = levelWeights(length, confidenceLevels, numLevels, estimator);
+        RiskKernels::parallelFor(numAssets, AssetGrain, [&](int begin, int end) {
+            for (int asset = begin; asset < end; ++asset) {
+                smoothedSeries(assetReturns + static_cast<size_t>(asset) * length, length, weights,
+                               valueAtRisk + static_cast<size_t>(asset) * numLevels);
+            }
+        });
+    }
+}
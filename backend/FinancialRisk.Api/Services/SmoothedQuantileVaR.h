@@ -0,0 +1,37 @@
+#ifndef SMOOTHED_QUANTILE_VAR_H
+#define SMOOTHED_QUANTILE_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Quantile estimator used by the smoothed historical VaR functions
+#define QUANTILE_EMPIRICAL 0      // order statistic int((1 - c) n), as CalculateHistoricalVaR
+#define QUANTILE_HARRELL_DAVIS 1  // weights I_{i/n}(a, b) - I_{(i-1)/n}(a, b), a = p (n + 1), b = (1 - p)(n + 1)
+#define QUANTILE_KERNEL 2         // Gaussian kernel in probability, bandwidth sqrt(p (1 - p) / n)
+
+// Historical VaR from a smoothed quantile of the returns: VaR = -sum_i w_i x_(i)
+// over the sorted sample, with p = 1 - c. A smoothed estimate moves by a small
+// amount when one observation enters or leaves the sample, where the
+// empirical order statistic can jump to a neighbouring value.
+//
+// The weight vector of each (estimator, n, level) is computed once and cached
+// process-wide, with the weights below 1e-17 trimmed from both ends. A call
+// partitions the sample so only the order statistics under those weights are
+// sorted, then takes one vectorized dot product per level. Levels outside
+// (0, 1), length < 2 and unknown estimators report 0.
+void CalculateSmoothedHistoricalVaR(double* returns, int length, double* confidenceLevels, int numLevels,
+                                    int estimator, double* valueAtRisk);
+
+// CalculateSmoothedHistoricalVaR for numAssets series of length observations
+// stored one after another, split across a thread pool; all series share the
+// cached weights. valueAtRisk is numAssets x numLevels, row-major.
+void CalculateBatchSmoothedHistoricalVaR(double* assetReturns, int numAssets, int length,
+                                         double* confidenceLevels, int numLevels, int estimator,
+                                         double* valueAtRisk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOOTHED_QUANTILE_VAR_H
@@ -0,0 +1,147 @@
+#ifndef RISK_THREAD_POOL_H
+#define RISK_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal fork-join pool used by the batch kernels. Work is handed out in
+// chunks from a shared counter, and the calling thread takes part in the work.
+namespace RiskKernels {
+
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned threadCount) {
+            for (unsigned i = 1; i < threadCount; ++i) {
+                workers.emplace_back([this] { workerLoop(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wakeWorkers.notify_all();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Process-wide pool sized to the hardware. Deliberately never destroyed:
+        // joining threads from a library's static destructors can deadlock on unload.
+        static ThreadPool& instance() {
+            static ThreadPool* pool = new ThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+            return *pool;
+        }
+
+        unsigned threadCount() const {
+            return static_cast<unsigned>(workers.size()) + 1;
+        }
+
+        // Call body(begin, end) for consecutive chunks of [0, count). Runs inline
+        // when the pool is busy with another caller or when called from a worker.
+        void parallelFor(int count, int grainSize, const std::function<void(int, int)>& body) {
+            if (count <= 0) return;
+            grainSize = std::max(1, grainSize);
+            int chunks = (count + grainSize - 1) / grainSize;
+
+            std::unique_lock<std::mutex> jobLock(jobMutex, std::try_to_lock);
+            if (chunks == 1 || workers.empty() || insideWorker() || !jobLock.owns_lock()) {
+                body(0, count);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                job = &body;
+                jobCount = count;
+                jobGrain = grainSize;
+                nextChunk.store(0);
+                pendingChunks = chunks;
+                ++generation;
+            }
+            wakeWorkers.notify_all();
+
+            runChunks(body, count, grainSize);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            jobDone.wait(lock, [this] { return pendingChunks == 0 && activeWorkers == 0; });
+            job = nullptr;
+        }
+
+    private:
+        static bool& insideWorker() {
+            static thread_local bool flag = false;
+            return flag;
+        }
+
+        void runChunks(const std::function<void(int, int)>& body, int count, int grainSize) {
+            int completed = 0;
+            for (;;) {
+                int begin = nextChunk.fetch_add(1) * grainSize;
+                if (begin >= count) break;
+                body(begin, std::min(count, begin + grainSize));
+                ++completed;
+            }
+            if (completed > 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                pendingChunks -= completed;
+                if (pendingChunks == 0) jobDone.notify_all();
+            }
+        }
+
+        void workerLoop() {
+            insideWorker() = true;
+            unsigned long seenGeneration = 0;
+            for (;;) {
+                const std::function<void(int, int)>* body;
+                int count, grainSize;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wakeWorkers.wait(lock, [&] { return stopping || (job != nullptr && generation != seenGeneration); });
+                    if (stopping) return;
+                    seenGeneration = generation;
+                    body = job;
+                    count = jobCount;
+                    grainSize = jobGrain;
+                    ++activeWorkers;
+                }
+                runChunks(*body, count, grainSize);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --activeWorkers;
+                    if (pendingChunks == 0 && activeWorkers == 0) jobDone.notify_all();
+                }
+            }
+        }
+
+        std::vector<std::thread> workers;
+        std::mutex jobMutex;
+        std::mutex mutex;
+        std::condition_variable wakeWorkers;
+        std::condition_variable jobDone;
+        const std::function<void(int, int)>* job = nullptr;
+        int jobCount = 0;
+        int jobGrain = 1;
+        std::atomic<int> nextChunk{0};
+        int pendingChunks = 0;
+        int activeWorkers = 0;
+        unsigned long generation = 0;
+        bool stopping = false;
+    };
+
+    // Convenience wrapper over the shared pool
+    inline void parallelFor(int count, int grainSize, const std::function<void(int, int)>& body) {
+        ThreadPool::instance().parallelFor(count, grainSize, body);
+    }
+}
+
+#endif // RISK_THREAD_POOL_H
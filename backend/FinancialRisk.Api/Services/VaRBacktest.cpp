@@ -0,0 +1,146 @@
+#include "VaRBacktest.h"
+#include "OrderStatisticTree.h"
+#include "QuantileKernels.h"
+#include "DistributionKernels.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const double EwmaLambda = 0.94;
+    const double GreenZoneLimit = 0.95;
+    const double RedZoneLimit = 0.9999;
+    
+    // x log(y), with 0 log 0 = 0
+    double xLogY(double x, double y) {
+        return x > 0.0 ? x * std::log(y) : 0.0;
+    }
+    
+    // Kupiec, Christoffersen and traffic-light statistics from the exception
+    // count and the exception transition counts (transitions[i][j]: day with
+    // state i followed by a day with state j)
+    VaRBacktestStatistics coverageStatistics(int observations, int exceptions, const int transitions[2][2],
+                                             double tail) {
+        VaRBacktestStatistics stats{};
+        stats.observations = observations;
+        stats.exceptions = exceptions;
+        const double n = observations, x = exceptions;
+        stats.exceptionRate = x / n;
+        
+        stats.kupiecStatistic = std::max(0.0, -2.0 * (xLogY(n - x, 1.0 - tail) + xLogY(x, tail)
+                                                      - xLogY(n - x, 1.0 - x / n) - xLogY(x, x / n)));
+        stats.kupiecPValue = std::erfc(std::sqrt(0.5 * stats.kupiecStatistic));
+        
+        const double n00 = transitions[0][0], n01 = transitions[0][1];
+        const double n10 = transitions[1][0], n11 = transitions[1][1];
+        const double pi0 = n00 + n01 > 0.0 ? n01 / (n00 + n01) : 0.0;
+        const double pi1 = n10 + n11 > 0.0 ? n11 / (n10 + n11) : 0.0;
+        const double pairs = n00 + n01 + n10 + n11;
+        const double pi = pairs > 0.0 ? (n01 + n11) / pairs : 0.0;
+        const double restricted = xLogY(n00 + n10, 1.0 - pi) + xLogY(n01 + n11, pi);
+        const double unrestricted = xLogY(n00, 1.0 - pi0) + xLogY(n01, pi0) + xLogY(n10, 1.0 - pi1) + xLogY(n11, pi1);
+        stats.christoffersenStatistic = std::max(0.0, -2.0 * (restricted - unrestricted));
+        stats.christoffersenPValue = std::erfc(std::sqrt(0.5 * stats.christoffersenStatistic));
+        
+        stats.conditionalCoverageStatistic = stats.kupiecStatistic + stats.christoffersenStatistic;
+        stats.conditionalCoveragePValue = std::exp(-0.5 * stats.conditionalCoverageStatistic);
+        
+        // P(X <= k) = I_{1-p}(n - k, k + 1)
+        stats.cumulativeProbability = exceptions >= observations
+            ? 1.0 : RiskKernels::incompleteBeta(1.0 - tail, n - x, x + 1.0);
+        stats.trafficLight = stats.cumulativeProbability < GreenZoneLimit ? TRAFFIC_LIGHT_GREEN
+                           : stats.cumulativeProbability < RedZoneLimit ? TRAFFIC_LIGHT_YELLOW
+                           : TRAFFIC_LIGHT_RED;
+        return stats;
+    }
+    
+    // VaR forecasts of one series for days [windowLength, length)
+    void forecastSeries(const double* returns, int length, int windowLength, double confidenceLevel, int method,
+                        double* forecast) {
+        const int index = RiskKernels::historicalVaRIndex(confidenceLevel, windowLength);
+        
+        if (method == BACKTEST_HISTORICAL) {
+            RiskKernels::OrderStatisticTree window(returns, length);
+            for (int t = 0; t < windowLength; ++t) window.insert(t);
+            for (int t = windowLength; t < length; ++t) {
+                forecast[t] = -window.kth(index);
+                window.insert(t);
+                window.remove(t - windowLength);
+            }
+        } else if (method == BACKTEST_PARAMETRIC) {
+            // Sums of returns - returns[0] keep the variance from cancelling
+            const double z = RiskKernels::inverseNormal(confidenceLevel);
+            const double shift = returns[0];
+            const double w = windowLength;
+            double sum = 0.0, sumSq = 0.0;
+            for (int t = 0; t < windowLength; ++t) {
+                const double d = returns[t] - shift;
+                sum += d;
+                sumSq += d * d;
+            }
+            for (int t = windowLength; t < length; ++t) {
+                const double variance = std::max(0.0, (sumSq - sum * sum / w) / (w - 1.0));
+                forecast[t] = -(shift + sum / w - z * std::sqrt(variance));
+                const double added = returns[t] - shift, removed = returns[t - windowLength] - shift;
+                sum += added - removed;
+                sumSq += added * added - removed * removed;
+            }
+        } else {
+            // variance[t] is the EWMA forecast for day t made after day t - 1
+            double seed = 0.0;
+            for (int t = 0; t < windowLength; ++t) seed += returns[t] * returns[t];
+            std::vector<double> variance(length), standardized(length);
+            variance[0] = seed / windowLength;
+            for (int t = 0; t < length; ++t) {
+                if (t > 0) variance[t] = EwmaLambda * variance[t - 1] + (1.0 - EwmaLambda) * returns[t - 1] * returns[t - 1];
+                standardized[t] = variance[t] > 0.0 ? returns[t] / std::sqrt(variance[t]) : 0.0;
+            }
+            RiskKernels::OrderStatisticTree window(standardized.data(), length);
+            for (int t = 0; t < windowLength; ++t) window.insert(t);
+            for (int t = windowLength; t < length; ++t) {
+                forecast[t] = -std::sqrt(variance[t]) * window.kth(index);
+                window.insert(t);
+                window.remove(t - windowLength);
+            }
+        }
+    }
+}
+
+extern "C" {
+    // Rolling out-of-sample VaR backtest with coverage tests
+    void BacktestVaR(double* assetReturns, int numAssets, int length, int windowLength,
+                     double confidenceLevel, int method,
+                     VaRBacktestStatistics* statistics, double* forecasts) {
+        if (statistics == nullptr || numAssets <= 0) return;
+        std::fill(statistics, statistics + numAssets, VaRBacktestStatistics{});
+        if (assetReturns == nullptr || length <= 0) return;
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        if (forecasts) std::fill(forecasts, forecasts + static_cast<size_t>(numAssets) * length, nan);
+        if (windowLength < 2 || windowLength >= length) return;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return;
+        if (method != BACKTEST_HISTORICAL && method != BACKTEST_PARAMETRIC && method != BACKTEST_FILTERED_HISTORICAL) return;
+        
+        RiskKernels::parallelFor(numAssets, 1, [&](int begin, int end) {
+            std::vector<double> local(forecasts ? 0 : length);
+            for (int asset = begin; asset < end; ++asset) {
+                const double* returns = assetReturns + static_cast<size_t>(asset) * length;
+                double* forecast = forecasts ? forecasts + static_cast<size_t>(asset) * length : local.data();
+                forecastSeries(returns, length, windowLength, confidenceLevel, method, forecast);
+                
+                int exceptions = 0;
+                int transitions[2][2] = {{0, 0}, {0, 0}};
+                int previous = -1;
+                for (int t = windowLength; t < length; ++t) {
+                    const int exception = returns[t] < -forecast[t] ? 1 : 0;
+                    exceptions += exception;
+                    if (previous >= 0) ++transitions[previous][exception];
+                    previous = exception;
+                }
+                statistics[asset] = coverageStatistics(length - windowLength, exceptions, transitions,
+                                                       1.0 - confidenceLevel);
+            }
+        });
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef VAR_BACKTEST_H
+#define VAR_BACKTEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// VaR model backtested by BacktestVaR
+#define BACKTEST_HISTORICAL 0           // historical VaR of the trailing window
+#define BACKTEST_PARAMETRIC 1           // normal VaR from the trailing window's mean and standard deviation
+#define BACKTEST_FILTERED_HISTORICAL 2  // EWMA-filtered historical simulation (lambda 0.94)
+
+// Basel traffic-light zones
+#define TRAFFIC_LIGHT_GREEN 0
+#define TRAFFIC_LIGHT_YELLOW 1
+#define TRAFFIC_LIGHT_RED 2
+
+// Exception counts and coverage tests of one backtested series
+typedef struct VaRBacktestStatistics {
+    int observations;                     // forecasts compared with realized returns
+    int exceptions;                       // days whose loss exceeded the VaR forecast
+    double exceptionRate;
+    double kupiecStatistic;               // proportion of failures LR, chi-square(1)
+    double kupiecPValue;
+    double christoffersenStatistic;       // independence LR on exception transitions, chi-square(1)
+    double christoffersenPValue;
+    double conditionalCoverageStatistic;  // Kupiec + Christoffersen, chi-square(2)
+    double conditionalCoveragePValue;
+    double cumulativeProbability;         // P(X <= exceptions), X ~ Binomial(observations, 1 - c)
+    int trafficLight;                     // TRAFFIC_LIGHT_* zone from cumulativeProbability
+} VaRBacktestStatistics;
+
+// Rolling out-of-sample VaR backtest of many series.
+//
+// assetReturns holds numAssets series of length observations, one after
+// another. For every day t >= windowLength the forecast uses returns
+// [t - windowLength, t) only and is compared with returns[t]; an exception is
+// returns[t] < -VaR. The trailing window is held in rolling structures, so a
+// forecast costs O(log windowLength):
+//   BACKTEST_HISTORICAL           order statistic of the window (as CalculateRollingHistoricalVaR)
+//   BACKTEST_PARAMETRIC           running mean and variance, -(mean - z sigma) with the AS241 quantile
+//   BACKTEST_FILTERED_HISTORICAL  returns are standardized by the EWMA volatility forecast made the
+//                                 day before (seeded with the first window's mean square), and VaR is
+//                                 the forecast volatility times the window's order statistic of the
+//                                 standardized returns
+// Assets are split across a thread pool.
+//
+// Traffic-light zones generalize the Basel table to any sample size and level:
+// green while cumulativeProbability < 0.95, red from 0.9999, yellow between
+// (0-4 / 5-9 / 10+ exceptions for 250 days at 99%).
+//
+// statistics receives numAssets entries. forecasts, if not null, receives
+// numAssets x length VaR forecasts (NaN before windowLength). Null or empty
+// returns, a series that leaves no forecast (windowLength < 2 or >= length),
+// an invalid confidence level or an unknown method give zeroed statistics.
+void BacktestVaR(double* assetReturns, int numAssets, int length, int windowLength,
+                 double confidenceLevel, int method,
+                 VaRBacktestStatistics* statistics, double* forecasts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VAR_BACKTEST_H
@@ -36,6 +36,14 @@ namespace FinancialRisk.Api.Services
         [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
         private static extern double CalculateParametricCVaR(double[] returns, int length, double confidenceLevel);
 
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateHistoricalVaRLevels(double[] returns, int length, double[] confidenceLevels, int numLevels,
+                                                                double[] valueAtRisk, double[] conditionalVaR);
+
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateParametricVaRLevels(double[] returns, int length, double[] confidenceLevels, int numLevels,
+                                                                double[] valueAtRisk, double[] conditionalVaR);
+
         [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
         private static extern double CalculateBootstrapVaR(double[] returns, int length, double confidenceLevel, int bootstrapSamples);
 
@@ -43,6 +51,94 @@ namespace FinancialRisk.Api.Services
         private static extern void CalculateVaRConfidenceIntervals(double[] returns, int length, double confidenceLevel, 
                                                                  int bootstrapSamples, out double lowerBound, out double upperBound);
 
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateBootstrapVaRStatistics(double[] returns, int length, double[] confidenceLevels, int numLevels,
+                                                                   int bootstrapSamples, double[] percentiles, int numPercentiles,
+                                                                   int method, ulong seed, BootstrapSummary[]? valueAtRisk,
+                                                                   BootstrapSummary[]? conditionalVaR,
+                                                                   double[] varPercentiles, double[] cvarPercentiles);
+
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateEulerVaRDecomposition(double[] assetReturns, double[] weights, int numAssets, int length,
+                                                                  double confidenceLevel, double bandwidth,
+                                                                  out double portfolioVaR, out double portfolioES,
+                                                                  double[] marginalVaR, double[] componentVaR,
+                                                                  double[] marginalES, double[] componentES);
+
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateFilteredHistoricalVaR(double[] returns, int length, double[] confidenceLevels, int numLevels,
+                                                                  double[] valueAtRisk, double[] expectedShortfall, out GarchFit fit);
+
+        // Mirrors the native GarchFit struct in FilteredHistoricalVaR.h
+        [StructLayout(LayoutKind.Sequential)]
+        private struct GarchFit
+        {
+            public double Mean;
+            public double Omega;
+            public double Alpha;
+            public double Beta;
+            public double ForecastVolatility;
+            public double LogLikelihood;
+        }
+
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void BacktestVaR(double[] assetReturns, int numAssets, int length, int windowLength,
+                                               double confidenceLevel, int method,
+                                               [Out] VaRBacktestStatistics[] statistics, double[]? forecasts);
+
+        // BACKTEST_* methods in VaRBacktest.h
+        private const int BacktestHistorical = 0;
+        private const int BacktestParametric = 1;
+        private const int BacktestFilteredHistorical = 2;
+        private const int BacktestWindow = 250;
+
+        // Mirrors the native VaRBacktestStatistics struct in VaRBacktest.h
+        [StructLayout(LayoutKind.Sequential)]
+        private struct VaRBacktestStatistics
+        {
+            public int Observations;
+            public int Exceptions;
+            public double ExceptionRate;
+            public double KupiecStatistic;
+            public double KupiecPValue;
+            public double ChristoffersenStatistic;
+            public double ChristoffersenPValue;
+            public double ConditionalCoverageStatistic;
+            public double ConditionalCoveragePValue;
+            public double CumulativeProbability;
+            public int TrafficLight;
+        }
+
+        [DllImport("VaRCalculations.dll", CallingConvention = CallingConvention.Cdecl)]
+        private static extern void CalculateExtremeValueVaR(double[] returns, int length, double thresholdFraction,
+                                                            double[] confidenceLevels, int numLevels,
+                                                            double[] valueAtRisk, double[] expectedShortfall, out GpdTailFit fit);
+
+        private const double ExtremeValueThresholdFraction = 0.1;
+
+        // Mirrors the native GpdTailFit struct in ExtremeValueVaR.h
+        [StructLayout(LayoutKind.Sequential)]
+        private struct GpdTailFit
+        {
+            public double Threshold;
+            public double Shape;
+            public double Scale;
+            public int Exceedances;
+            public double LogLikelihood;
+        }
+
+        // BOOTSTRAP_SORTED_COUNTS in BootstrapVaR.h: multinomial counts over the sorted sample
+        private const int BootstrapSortedCounts = 1;
+
+        // Mirrors the native BootstrapSummary struct in BootstrapVaR.h
+        [StructLayout(LayoutKind.Sequential)]
+        private struct BootstrapSummary
+        {
+            public double Mean;
+            public double Median;
+            public double StandardError;
+        }
+
         // C++ library imports for Monte Carlo simulation
         [DllImport("MonteCarloEngine.dll", CallingConvention = CallingConvention.Cdecl)]
         private static extern double CalculateMonteCarloVaR(double[] returns, int length, double confidenceLevel, 
@@ -64,6 +160,10 @@ namespace FinancialRisk.Api.Services
                                                                   double[][] correlationMatrix, int distributionType,
                                                                   double[] result);
 
+        // Confidence levels every VaR endpoint evaluates; one native call covers all of them
+        private static readonly double[] StandardConfidenceLevels = { 0.90, 0.95, 0.975, 0.99, 0.999 };
+        private const int Level95 = 1;
+
         public VaRCalculationService(
             ILogger<VaRCalculationService> logger,
             IFinancialDataService financialDataService,
@@ -108,6 +208,14 @@ namespace FinancialRisk.Api.Services
                 {
                     varResult = await CalculateMonteCarloVaRAsync(request, returns);
                 }
+                else if (request.CalculationType.ToLower() == "filteredhistorical")
+                {
+                    varResult = CalculateFilteredHistoricalVaR(request, returns);
+                }
+                else if (request.CalculationType.ToLower() == "extremevalue")
+                {
+                    varResult = CalculateExtremeValueVaR(request, returns);
+                }
                 else
                 {
                     varResult = CalculateHistoricalVaR(request, returns);
@@ -243,10 +351,9 @@ namespace FinancialRisk.Api.Services
                 var stressedReturns = ApplyStressFactor(returns, request.StressFactor, request.ScenarioType);
 
                 // Calculate VaR on stressed data
-                var var95 = CalculateHistoricalVaR(stressedReturns, stressedReturns.Length, 0.95);
-                var var99 = CalculateHistoricalVaR(stressedReturns, stressedReturns.Length, 0.99);
-                var cvar95 = CalculateHistoricalCVaR(stressedReturns, stressedReturns.Length, 0.95);
-                var cvar99 = CalculateHistoricalCVaR(stressedReturns, stressedReturns.Length, 0.99);
+                var (stressedVaR, stressedCVaR) = HistoricalVaRAtStandardLevels(stressedReturns);
+                var var95 = stressedVaR[Level95];
+                var cvar95 = stressedCVaR[Level95];
 
                 var stressTest = new VaRStressTest
                 {
@@ -311,22 +418,16 @@ namespace FinancialRisk.Api.Services
                 };
 
                 // Historical VaR
-                var historicalVar95 = CalculateHistoricalVaR(returns, returns.Length, 0.95);
-                var historicalVar99 = CalculateHistoricalVaR(returns, returns.Length, 0.99);
-                var historicalCvar95 = CalculateHistoricalCVaR(returns, returns.Length, 0.95);
-                var historicalCvar99 = CalculateHistoricalCVaR(returns, returns.Length, 0.99);
+                var (historicalVaR, historicalCVaR) = HistoricalVaRAtStandardLevels(returns);
 
-                comparison.VaRResults["Historical"] = historicalVar95;
-                comparison.CVaRResults["Historical"] = historicalCvar95;
+                comparison.VaRResults["Historical"] = historicalVaR[Level95];
+                comparison.CVaRResults["Historical"] = historicalCVaR[Level95];
 
                 // Parametric VaR
-                var parametricVar95 = CalculateParametricVaR(returns, returns.Length, 0.95);
-                var parametricVar99 = CalculateParametricVaR(returns, returns.Length, 0.99);
-                var parametricCvar95 = CalculateParametricCVaR(returns, returns.Length, 0.95);
-                var parametricCvar99 = CalculateParametricCVaR(returns, returns.Length, 0.99);
+                var (parametricVaR, parametricCVaR) = ParametricVaRAtStandardLevels(returns);
 
-                comparison.VaRResults["Parametric"] = parametricVar95;
-                comparison.CVaRResults["Parametric"] = parametricCvar95;
+                comparison.VaRResults["Parametric"] = parametricVaR[Level95];
+                comparison.CVaRResults["Parametric"] = parametricCVaR[Level95];
 
                 // Monte Carlo VaR
                 var monteCarloResult = await CalculateMonteCarloVaRAsync(new VaRCalculationRequest
@@ -363,22 +464,36 @@ namespace FinancialRisk.Api.Services
             {
                 _logger.LogInformation("Performing VaR backtest for {Symbol} using {Method}", symbol, method);
 
-                // This is a simplified backtest implementation
-                // In practice, you would implement proper backtesting with rolling windows
+                // Rolling out-of-sample forecasts over a one-year estimation window
+                var historyResult = await _financialDataService.GetStockHistoryAsync(symbol, backtestDays + BacktestWindow + 1);
+                var returns = historyResult.Success && historyResult.Data != null
+                    ? CalculateReturns(historyResult.Data)
+                    : new double[0];
+                var nativeMethod = method.ToLower() switch
+                {
+                    "parametric" => BacktestParametric,
+                    "filteredhistorical" => BacktestFilteredHistorical,
+                    _ => BacktestHistorical
+                };
+                var window = Math.Min(BacktestWindow, Math.Max(2, returns.Length - backtestDays));
+                var statistics = new VaRBacktestStatistics[1];
+                BacktestVaR(returns, 1, returns.Length, window, confidenceLevel, nativeMethod, statistics, null);
+                var stats = statistics[0];
+
                 var backtestResult = new VaRBacktestResult
                 {
                     Symbol = symbol,
                     Method = method,
                     ConfidenceLevel = confidenceLevel,
-                    BacktestPeriod = backtestDays,
-                    Violations = 0, // Would be calculated from actual backtest
-                    ViolationRate = 0.0,
-                    KupiecTestStatistic = 0.0,
-                    KupiecPValue = 1.0,
-                    KupiecTestPassed = true,
-                    ChristoffersenTestStatistic = 0.0,
-                    ChristoffersenPValue = 1.0,
-                    ChristoffersenTestPassed = true,
+                    BacktestPeriod = stats.Observations,
+                    Violations = stats.Exceptions,
+                    ViolationRate = stats.ExceptionRate,
+                    KupiecTestStatistic = stats.KupiecStatistic,
+                    KupiecPValue = stats.Observations > 0 ? stats.KupiecPValue : 1.0,
+                    KupiecTestPassed = stats.Observations == 0 || stats.KupiecPValue >= 0.05,
+                    ChristoffersenTestStatistic = stats.ChristoffersenStatistic,
+                    ChristoffersenPValue = stats.Observations > 0 ? stats.ChristoffersenPValue : 1.0,
+                    ChristoffersenTestPassed = stats.Observations == 0 || stats.ChristoffersenPValue >= 0.05,
                     BacktestDate = DateTime.UtcNow,
                     CreatedAt = DateTime.UtcNow
                 };
@@ -421,16 +536,37 @@ namespace FinancialRisk.Api.Services
             return returns;
         }
 
-        private VaRCalculation CalculateHistoricalVaR(VaRCalculationRequest request, double[] returns)
+        private static (double[] VaR, double[] CVaR) HistoricalVaRAtStandardLevels(double[] returns)
+        {
+            var valueAtRisk = new double[StandardConfidenceLevels.Length];
+            var conditionalVaR = new double[StandardConfidenceLevels.Length];
+            CalculateHistoricalVaRLevels(returns, returns.Length, StandardConfidenceLevels, StandardConfidenceLevels.Length,
+                                         valueAtRisk, conditionalVaR);
+            return (valueAtRisk, conditionalVaR);
+        }
+
+        private static (double[] VaR, double[] CVaR) ParametricVaRAtStandardLevels(double[] returns)
         {
-            var var95 = CalculateHistoricalVaR(returns, returns.Length, 0.95);
-            var var99 = CalculateHistoricalVaR(returns, returns.Length, 0.99);
-            var cvar95 = CalculateHistoricalCVaR(returns, returns.Length, 0.95);
-            var cvar99 = CalculateHistoricalCVaR(returns, returns.Length, 0.99);
+            var valueAtRisk = new double[StandardConfidenceLevels.Length];
+            var conditionalVaR = new double[StandardConfidenceLevels.Length];
+            CalculateParametricVaRLevels(returns, returns.Length, StandardConfidenceLevels, StandardConfidenceLevels.Length,
+                                         valueAtRisk, conditionalVaR);
+            return (valueAtRisk, conditionalVaR);
+        }
 
-            // Calculate confidence intervals
-            CalculateVaRConfidenceIntervals(returns, returns.Length, 0.95, 1000, out double var95Lower, out double var95Upper);
-            CalculateVaRConfidenceIntervals(returns, returns.Length, 0.99, 1000, out double var99Lower, out double var99Upper);
+        private VaRCalculation CalculateHistoricalVaR(VaRCalculationRequest request, double[] returns)
+        {
+            var (valueAtRisk, conditionalVaR) = HistoricalVaRAtStandardLevels(returns);
+            var var95 = valueAtRisk[Level95];
+            var cvar95 = conditionalVaR[Level95];
+
+            // VaR and CVaR confidence intervals from one set of bootstrap replicates
+            double[] levels = { 0.95 };
+            double[] percentiles = { 0.05, 0.95 };
+            var varBounds = new double[percentiles.Length];
+            var cvarBounds = new double[percentiles.Length];
+            CalculateBootstrapVaRStatistics(returns, returns.Length, levels, levels.Length, 1000, percentiles, percentiles.Length,
+                                            BootstrapSortedCounts, (ulong)Random.Shared.NextInt64(), null, null, varBounds, cvarBounds);
 
             return new VaRCalculation
             {
@@ -440,10 +576,10 @@ namespace FinancialRisk.Api.Services
                 ConfidenceLevel = 0.95,
                 VaR = var95,
                 CVaR = cvar95,
-                VaRLowerBound = var95Lower,
-                VaRUpperBound = var95Upper,
-                CVaRLowerBound = var95Lower,
-                CVaRUpperBound = var95Upper,
+                VaRLowerBound = varBounds[0],
+                VaRUpperBound = varBounds[1],
+                CVaRLowerBound = cvarBounds[0],
+                CVaRUpperBound = cvarBounds[1],
                 SampleSize = returns.Length,
                 SimulationCount = 0,
                 TimeHorizon = request.TimeHorizon,
@@ -453,6 +589,73 @@ namespace FinancialRisk.Api.Services
             };
         }
 
+        private VaRCalculation CalculateFilteredHistoricalVaR(VaRCalculationRequest request, double[] returns)
+        {
+            // GARCH(1,1)-filtered historical simulation, fitted natively
+            var valueAtRisk = new double[StandardConfidenceLevels.Length];
+            var expectedShortfall = new double[StandardConfidenceLevels.Length];
+            CalculateFilteredHistoricalVaR(returns, returns.Length, StandardConfidenceLevels, StandardConfidenceLevels.Length,
+                                           valueAtRisk, expectedShortfall, out GarchFit fit);
+
+            return new VaRCalculation
+            {
+                Symbol = request.Symbol,
+                CalculationType = request.CalculationType,
+                DistributionType = request.DistributionType,
+                ConfidenceLevel = 0.95,
+                VaR = valueAtRisk[Level95],
+                CVaR = expectedShortfall[Level95],
+                SampleSize = returns.Length,
+                SimulationCount = 0,
+                TimeHorizon = request.TimeHorizon,
+                CalculationDate = DateTime.UtcNow,
+                CreatedAt = DateTime.UtcNow,
+                Parameters = JsonSerializer.Serialize(new
+                {
+                    request.Parameters,
+                    Garch = new { fit.Omega, fit.Alpha, fit.Beta, fit.ForecastVolatility }
+                })
+            };
+        }
+
+        private VaRCalculation CalculateExtremeValueVaR(VaRCalculationRequest request, double[] returns)
+        {
+            // Peaks over threshold: GPD fitted to the largest 10% of losses
+            var valueAtRisk = new double[StandardConfidenceLevels.Length];
+            var expectedShortfall = new double[StandardConfidenceLevels.Length];
+            CalculateExtremeValueVaR(returns, returns.Length, ExtremeValueThresholdFraction, StandardConfidenceLevels,
+                                     StandardConfidenceLevels.Length, valueAtRisk, expectedShortfall, out GpdTailFit fit);
+            if (fit.Exceedances == 0)
+            {
+                // Too few losses over the threshold (or no regular fit): the zeros are not a risk number
+                _logger.LogWarning("GPD tail fit failed for {Symbol} with {Count} returns, falling back to historical VaR",
+                    request.Symbol, returns.Length);
+                return CalculateHistoricalVaR(request, returns);
+            }
+
+            return new VaRCalculation
+            {
+                Symbol = request.Symbol,
+                CalculationType = request.CalculationType,
+                DistributionType = request.DistributionType,
+                ConfidenceLevel = 0.95,
+                VaR = valueAtRisk[Level95],
+                CVaR = expectedShortfall[Level95],
+                SampleSize = returns.Length,
+                SimulationCount = 0,
+                TimeHorizon = request.TimeHorizon,
+                CalculationDate = DateTime.UtcNow,
+                CreatedAt = DateTime.UtcNow,
+                Parameters = JsonSerializer.Serialize(new
+                {
+                    request.Parameters,
+                    Gpd = new { fit.Threshold, fit.Shape, fit.Scale, fit.Exceedances },
+                    VaR999 = valueAtRisk[StandardConfidenceLevels.Length - 1],
+                    CVaR999 = expectedShortfall[StandardConfidenceLevels.Length - 1]
+                })
+            };
+        }
+
         private async Task<VaRCalculation> CalculateMonteCarloVaRAsync(VaRCalculationRequest request, double[] returns)
         {
             try
@@ -670,10 +873,9 @@ namespace FinancialRisk.Api.Services
             // Calculate portfolio returns
             var portfolioReturns = CalculatePortfolioReturns(assetData, request.Weights);
 
-            var var95 = CalculateHistoricalVaR(portfolioReturns, portfolioReturns.Length, 0.95);
-            var var99 = CalculateHistoricalVaR(portfolioReturns, portfolioReturns.Length, 0.99);
-            var cvar95 = CalculateHistoricalCVaR(portfolioReturns, portfolioReturns.Length, 0.95);
-            var cvar99 = CalculateHistoricalCVaR(portfolioReturns, portfolioReturns.Length, 0.99);
+            var (portfolioVaR, portfolioCVaR) = HistoricalVaRAtStandardLevels(portfolioReturns);
+            var var95 = portfolioVaR[Level95];
+            var cvar95 = portfolioCVaR[Level95];
 
             var portfolioResult = new PortfolioVaRCalculation
             {
@@ -691,24 +893,37 @@ namespace FinancialRisk.Api.Services
                 Parameters = JsonSerializer.Serialize(request.Parameters)
             };
 
-            // Calculate asset contributions
-            var contributions = new List<VaRAssetContribution>();
-            for (int i = 0; i < request.Symbols.Count; i++)
+            // Euler decomposition: the asset components add up to portfolio VaR and CVaR
+            var numAssets = request.Symbols.Count;
+            var length = portfolioReturns.Length;
+            var assetMatrix = new double[numAssets * length];
+            var weights = new double[numAssets];
+            for (int i = 0; i < numAssets; i++)
             {
-                var symbol = request.Symbols[i];
-                var weight = (double)request.Weights[i];
-                var assetReturns = assetData[symbol];
-                var assetVar = CalculateHistoricalVaR(assetReturns, assetReturns.Length, 0.95);
+                Array.Copy(assetData[request.Symbols[i]], 0, assetMatrix, i * length, length);
+                weights[i] = (double)request.Weights[i];
+            }
+
+            var marginalVaR = new double[numAssets];
+            var componentVaR = new double[numAssets];
+            var marginalES = new double[numAssets];
+            var componentES = new double[numAssets];
+            CalculateEulerVaRDecomposition(assetMatrix, weights, numAssets, length, 0.95, 0.0,
+                                           out double eulerVaR, out double eulerES,
+                                           marginalVaR, componentVaR, marginalES, componentES);
 
+            var contributions = new List<VaRAssetContribution>();
+            for (int i = 0; i < numAssets; i++)
+            {
                 contributions.Add(new VaRAssetContribution
                 {
                     PortfolioVaRCalculationId = 0, // Will be set when saved
-                    Symbol = symbol,
-                    Weight = (double)request.Weights[i],
-                    VaRContribution = weight * assetVar / var95,
-                    CVaRContribution = weight * assetVar / cvar95,
-                    MarginalVaR = assetVar,
-                    ComponentVaR = weight * assetVar,
+                    Symbol = request.Symbols[i],
+                    Weight = weights[i],
+                    VaRContribution = eulerVaR != 0 ? componentVaR[i] / eulerVaR : 0.0,
+                    CVaRContribution = eulerES != 0 ? componentES[i] / eulerES : 0.0,
+                    MarginalVaR = marginalVaR[i],
+                    ComponentVaR = componentVaR[i],
                     CreatedAt = DateTime.UtcNow
                 });
             }
@@ -1,3 +1,7 @@
+#include "BootstrapVaR.h"
+#include "VaRDecomposition.h"
+#include "QuantileKernels.h"
+#include "DistributionKernels.h"
 #include <vector>
 #include <algorithm>
 #include <numeric>
@@ -5,23 +9,49 @@
 #include <stdexcept>
 #include <random>
 
+namespace {
+    // Sample mean and standard deviation used by the parametric functions
+    void sampleMoments(const double* returns, int length, double& mean, double& stdDev) {
+        double sum = 0.0;
+        for (int i = 0; i < length; ++i) {
+            sum += returns[i];
+        }
+        mean = sum / length;
+        
+        double variance = 0.0;
+        for (int i = 0; i < length; ++i) {
+            double diff = returns[i] - mean;
+            variance += diff * diff;
+        }
+        variance /= (length - 1);
+        stdDev = std::sqrt(variance);
+    }
+    
+    // Standard normal quantile of the confidence level (AS241)
+    double parametricZScore(double confidenceLevel) {
+        return RiskKernels::inverseNormal(confidenceLevel);
+    }
+    
+    // Parametric CVaR = -(mean - stdDev * phi(zScore) / (1 - confidenceLevel)),
+    // where phi is the standard normal PDF
+    double normalTailLoss(double mean, double stdDev, double confidenceLevel) {
+        double zScore = parametricZScore(confidenceLevel);
+        double phi = RiskKernels::normalDensity(zScore);
+        return -(mean - stdDev * phi / (1.0 - confidenceLevel));
+    }
+}
+
 extern "C" {
     // Historical VaR using percentile method
     double CalculateHistoricalVaR(double* returns, int length, double confidenceLevel) {
         if (length < 2) return 0.0;
         if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
         
-        // Create a copy of returns for sorting
-        std::vector<double> sortedReturns(returns, returns + length);
-        std::sort(sortedReturns.begin(), sortedReturns.end());
-        
-        // Calculate the index for the confidence level
-        int index = static_cast<int>((1.0 - confidenceLevel) * length);
-        if (index >= length) index = length - 1;
-        if (index < 0) index = 0;
+        // Select the order statistic for the confidence level
+        int index = RiskKernels::historicalVaRIndex(confidenceLevel, length);
         
         // Return negative VaR (loss)
-        return -sortedReturns[index];
+        return -RiskKernels::selectOrderStatistic(returns, length, index);
     }
     
     // Historical CVaR (Expected Shortfall) using percentile method
@@ -29,60 +59,43 @@ extern "C" {
         if (length < 2) return 0.0;
         if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
         
-        // Create a copy of returns for sorting
-        std::vector<double> sortedReturns(returns, returns + length);
-        std::sort(sortedReturns.begin(), sortedReturns.end());
-        
-        // Calculate the number of observations in the tail
-        int tailCount = static_cast<int>((1.0 - confidenceLevel) * length);
-        if (tailCount <= 0) tailCount = 1;
-        if (tailCount > length) tailCount = length;
-        
         // Calculate average of the worst returns
-        double tailSum = 0.0;
-        for (int i = 0; i < tailCount; ++i) {
-            tailSum += sortedReturns[i];
-        }
+        int tailCount = RiskKernels::historicalTailCount(confidenceLevel, length);
+        double tailSum = RiskKernels::sumSmallest(returns, length, tailCount);
         
         // Return negative CVaR (average loss)
         return -(tailSum / tailCount);
     }
     
+    // Historical VaR over float32 returns
+    double CalculateHistoricalVaRFloat(float* returns, int length, double confidenceLevel) {
+        if (length < 2) return 0.0;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
+        
+        int index = RiskKernels::historicalVaRIndex(confidenceLevel, length);
+        return -static_cast<double>(RiskKernels::selectOrderStatistic(returns, length, index));
+    }
+    
+    // Historical CVaR over float32 returns
+    double CalculateHistoricalCVaRFloat(float* returns, int length, double confidenceLevel) {
+        if (length < 2) return 0.0;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
+        
+        int tailCount = RiskKernels::historicalTailCount(confidenceLevel, length);
+        return -(RiskKernels::sumSmallest(returns, length, tailCount) / tailCount);
+    }
+    
     // Parametric VaR using normal distribution assumption
     double CalculateParametricVaR(double* returns, int length, double confidenceLevel) {
         if (length < 2) return 0.0;
         if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
         
         // Calculate mean and standard deviation
-        double sum = 0.0;
-        for (int i = 0; i < length; ++i) {
-            sum += returns[i];
-        }
-        double mean = sum / length;
-        
-        double variance = 0.0;
-        for (int i = 0; i < length; ++i) {
-            double diff = returns[i] - mean;
-            variance += diff * diff;
-        }
-        variance /= (length - 1);
-        double stdDev = std::sqrt(variance);
-        
-        // Calculate z-score for confidence level
-        double zScore = 0.0;
-        if (confidenceLevel == 0.95) {
-            zScore = 1.645;
-        } else if (confidenceLevel == 0.99) {
-            zScore = 2.326;
-        } else if (confidenceLevel == 0.90) {
-            zScore = 1.282;
-        } else {
-            // Approximate z-score using inverse normal CDF approximation
-            zScore = std::sqrt(2.0) * std::erf(2.0 * confidenceLevel - 1.0);
-        }
+        double mean = 0.0, stdDev = 0.0;
+        sampleMoments(returns, length, mean, stdDev);
         
         // Parametric VaR = mean - zScore * stdDev
-        return -(mean - zScore * stdDev);
+        return -(mean - parametricZScore(confidenceLevel) * stdDev);
     }
     
     // Parametric CVaR using normal distribution assumption
@@ -91,130 +104,78 @@ extern "C" {
         if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
         
         // Calculate mean and standard deviation
-        double sum = 0.0;
-        for (int i = 0; i < length; ++i) {
-            sum += returns[i];
-        }
-        double mean = sum / length;
+        double mean = 0.0, stdDev = 0.0;
+        sampleMoments(returns, length, mean, stdDev);
         
-        double variance = 0.0;
-        for (int i = 0; i < length; ++i) {
-            double diff = returns[i] - mean;
-            variance += diff * diff;
-        }
-        variance /= (length - 1);
-        double stdDev = std::sqrt(variance);
-        
-        // Calculate z-score for confidence level
-        double zScore = 0.0;
-        if (confidenceLevel == 0.95) {
-            zScore = 1.645;
-        } else if (confidenceLevel == 0.99) {
-            zScore = 2.326;
-        } else if (confidenceLevel == 0.90) {
-            zScore = 1.282;
-        } else {
-            zScore = std::sqrt(2.0) * std::erf(2.0 * confidenceLevel - 1.0);
+        return normalTailLoss(mean, stdDev, confidenceLevel);
+    }
+    
+    // Historical VaR and CVaR at several confidence levels
+    void CalculateHistoricalVaRLevels(double* returns, int length, double* confidenceLevels, int numLevels,
+                                      double* valueAtRisk, double* conditionalVaR) {
+        if (returns == nullptr || confidenceLevels == nullptr || numLevels <= 0) return;
+        
+        // Invalid levels report 0 like the single-level functions; the rest share one selection
+        std::vector<double> levels;
+        std::vector<int> positions;
+        for (int level = 0; level < numLevels; ++level) {
+            if (valueAtRisk) valueAtRisk[level] = 0.0;
+            if (conditionalVaR) conditionalVaR[level] = 0.0;
+            if (length >= 2 && confidenceLevels[level] > 0.0 && confidenceLevels[level] < 1.0) {
+                levels.push_back(confidenceLevels[level]);
+                positions.push_back(level);
+            }
         }
+        if (levels.empty()) return;
         
-        // Parametric CVaR = mean - stdDev * phi(zScore) / (1 - confidenceLevel)
-        // where phi is the standard normal PDF
-        double phi = (1.0 / std::sqrt(2.0 * M_PI)) * std::exp(-0.5 * zScore * zScore);
-        double parametricCVaR = mean - stdDev * phi / (1.0 - confidenceLevel);
+        const int valid = static_cast<int>(levels.size());
+        std::vector<double> var(valid), cvar(valid);
+        double* work = RiskKernels::quantileScratch(returns, length);
+        int maxTail = RiskKernels::selectVaRLevels(work, length, levels.data(), valid, var.data());
+        RiskKernels::tailAveragesOfLevels(work, length, levels.data(), valid, maxTail, cvar.data());
         
-        return -parametricCVaR;
+        for (int i = 0; i < valid; ++i) {
+            if (valueAtRisk) valueAtRisk[positions[i]] = var[i];
+            if (conditionalVaR) conditionalVaR[positions[i]] = cvar[i];
+        }
+    }
+    
+    // Parametric VaR and CVaR at several confidence levels
+    void CalculateParametricVaRLevels(double* returns, int length, double* confidenceLevels, int numLevels,
+                                      double* valueAtRisk, double* conditionalVaR) {
+        if (returns == nullptr || confidenceLevels == nullptr || numLevels <= 0) return;
+        
+        // The moments are shared by every level
+        double mean = 0.0, stdDev = 0.0;
+        if (length >= 2) sampleMoments(returns, length, mean, stdDev);
+        
+        for (int level = 0; level < numLevels; ++level) {
+            double confidenceLevel = confidenceLevels[level];
+            bool valid = length >= 2 && confidenceLevel > 0.0 && confidenceLevel < 1.0;
+            if (valueAtRisk) {
+                valueAtRisk[level] = valid ? -(mean - parametricZScore(confidenceLevel) * stdDev) : 0.0;
+            }
+            if (conditionalVaR) {
+                conditionalVaR[level] = valid ? normalTailLoss(mean, stdDev, confidenceLevel) : 0.0;
+            }
+        }
     }
     
     // Bootstrap VaR using resampling
     double CalculateBootstrapVaR(double* returns, int length, double confidenceLevel, int bootstrapSamples) {
-        if (length < 2) return 0.0;
-        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return 0.0;
-        if (bootstrapSamples <= 0) bootstrapSamples = 1000;
-        
+        // Unseeded entry point: draw a fresh seed, then run the parallel engine
         std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, length - 1);
-        
-        std::vector<double> bootstrapVaRs;
-        bootstrapVaRs.reserve(bootstrapSamples);
-        
-        for (int i = 0; i < bootstrapSamples; ++i) {
-            // Create bootstrap sample
-            std::vector<double> bootstrapSample;
-            bootstrapSample.reserve(length);
-            
-            for (int j = 0; j < length; ++j) {
-                int randomIndex = dis(gen);
-                bootstrapSample.push_back(returns[randomIndex]);
-            }
-            
-            // Calculate VaR for this bootstrap sample
-            std::sort(bootstrapSample.begin(), bootstrapSample.end());
-            int index = static_cast<int>((1.0 - confidenceLevel) * length);
-            if (index >= length) index = length - 1;
-            if (index < 0) index = 0;
-            
-            double var = -bootstrapSample[index];
-            bootstrapVaRs.push_back(var);
-        }
-        
-        // Calculate mean of bootstrap VaRs
-        double sum = 0.0;
-        for (double var : bootstrapVaRs) {
-            sum += var;
-        }
-        
-        return sum / bootstrapSamples;
+        unsigned long long seed = (static_cast<unsigned long long>(rd()) << 32) ^ rd();
+        return CalculateBootstrapVaRSeeded(returns, length, confidenceLevel, bootstrapSamples, seed);
     }
     
     // Calculate VaR confidence intervals using bootstrap
     void CalculateVaRConfidenceIntervals(double* returns, int length, double confidenceLevel, 
                                        int bootstrapSamples, double* lowerBound, double* upperBound) {
-        if (length < 2) {
-            *lowerBound = 0.0;
-            *upperBound = 0.0;
-            return;
-        }
-        
         std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, length - 1);
-        
-        std::vector<double> bootstrapVaRs;
-        bootstrapVaRs.reserve(bootstrapSamples);
-        
-        for (int i = 0; i < bootstrapSamples; ++i) {
-            std::vector<double> bootstrapSample;
-            bootstrapSample.reserve(length);
-            
-            for (int j = 0; j < length; ++j) {
-                int randomIndex = dis(gen);
-                bootstrapSample.push_back(returns[randomIndex]);
-            }
-            
-            std::sort(bootstrapSample.begin(), bootstrapSample.end());
-            int index = static_cast<int>((1.0 - confidenceLevel) * length);
-            if (index >= length) index = length - 1;
-            if (index < 0) index = 0;
-            
-            double var = -bootstrapSample[index];
-            bootstrapVaRs.push_back(var);
-        }
-        
-        // Sort bootstrap VaRs for percentile calculation
-        std::sort(bootstrapVaRs.begin(), bootstrapVaRs.end());
-        
-        // Calculate 5th and 95th percentiles for confidence intervals
-        int lowerIndex = static_cast<int>(0.05 * bootstrapSamples);
-        int upperIndex = static_cast<int>(0.95 * bootstrapSamples);
-        
-        if (lowerIndex >= bootstrapSamples) lowerIndex = bootstrapSamples - 1;
-        if (upperIndex >= bootstrapSamples) upperIndex = bootstrapSamples - 1;
-        if (lowerIndex < 0) lowerIndex = 0;
-        if (upperIndex < 0) upperIndex = 0;
-        
-        *lowerBound = bootstrapVaRs[lowerIndex];
-        *upperBound = bootstrapVaRs[upperIndex];
+        unsigned long long seed = (static_cast<unsigned long long>(rd()) << 32) ^ rd();
+        CalculateVaRConfidenceIntervalsSeeded(returns, length, confidenceLevel, bootstrapSamples, seed,
+                                              lowerBound, upperBound);
     }
     
     // Calculate portfolio VaR using historical simulation
@@ -232,22 +193,14 @@ extern "C" {
                                   double confidenceLevel, double* contributions) {
         if (numAssets <= 0 || length <= 0) return;
         
-        // Calculate portfolio returns
-        std::vector<double> portfolioReturns(length, 0.0);
-        for (int i = 0; i < length; ++i) {
-            for (int j = 0; j < numAssets; ++j) {
-                portfolioReturns[i] += weights[j] * assetReturns[j * length + i];
-            }
-        }
-        
-        // Calculate portfolio VaR
-        double portfolioVaR = CalculateHistoricalVaR(portfolioReturns.data(), length, confidenceLevel);
-        
-        // Calculate individual asset VaR contributions
+        // Euler components as fractions of portfolio VaR, so they sum to one
+        double portfolioVaR = 0.0;
+        std::fill(contributions, contributions + numAssets, 0.0);
+        CalculateEulerVaRDecomposition(assetReturns, weights, numAssets, length, confidenceLevel, 0.0,
+                                       &portfolioVaR, nullptr, nullptr, contributions, nullptr, nullptr);
+        if (portfolioVaR == 0.0) return;
         for (int j = 0; j < numAssets; ++j) {
-            std::vector<double> assetReturnSeries(assetReturns + j * length, assetReturns + j * length + length);
-            double assetVaR = CalculateHistoricalVaR(assetReturnSeries.data(), length, confidenceLevel);
-            contributions[j] = weights[j] * assetVaR / portfolioVaR;
+            contributions[j] /= portfolioVaR;
         }
     }
 }
@@ -11,13 +11,32 @@ double CalculateHistoricalVaR(double* returns, int length, double confidenceLeve
 // Historical CVaR (Expected Shortfall) using percentile method
 double CalculateHistoricalCVaR(double* returns, int length, double confidenceLevel);
 
+// Historical VaR over float32 returns. The order statistic is a float value,
+// so the result differs from the double path only by input rounding (2^-24 relative)
+double CalculateHistoricalVaRFloat(float* returns, int length, double confidenceLevel);
+
+// Historical CVaR over float32 returns, with the tail averaged in double
+double CalculateHistoricalCVaRFloat(float* returns, int length, double confidenceLevel);
+
 // Parametric VaR using normal distribution assumption
 double CalculateParametricVaR(double* returns, int length, double confidenceLevel);
 
 // Parametric CVaR using normal distribution assumption
 double CalculateParametricCVaR(double* returns, int length, double confidenceLevel);
 
-// Bootstrap VaR using resampling
+// Historical VaR and CVaR for numLevels confidence levels in one call: a single
+// copy of the data is partitioned once per level from the largest order
+// statistic down, and every CVaR comes from prefix sums of the partitioned tail.
+// Levels outside (0, 1) report 0. Either output array may be null.
+void CalculateHistoricalVaRLevels(double* returns, int length, double* confidenceLevels, int numLevels,
+                                  double* valueAtRisk, double* conditionalVaR);
+
+// Parametric (normal) VaR and CVaR for numLevels confidence levels from one
+// computation of the sample moments
+void CalculateParametricVaRLevels(double* returns, int length, double* confidenceLevels, int numLevels,
+                                  double* valueAtRisk, double* conditionalVaR);
+
+// Bootstrap VaR using resampling (randomly seeded; see BootstrapVaR.h for the seeded engine)
 double CalculateBootstrapVaR(double* returns, int length, double confidenceLevel, int bootstrapSamples);
 
 // Calculate VaR confidence intervals using bootstrap
@@ -30,7 +49,8 @@ double CalculatePortfolioHistoricalVaR(double* portfolioReturns, int length, dou
 // Calculate portfolio CVaR using historical simulation
 double CalculatePortfolioHistoricalCVaR(double* portfolioReturns, int length, double confidenceLevel);
 
-// Calculate VaR decomposition (contribution of each asset to portfolio VaR)
+// Calculate VaR decomposition (contribution of each asset to portfolio VaR):
+// Euler component VaR as a fraction of portfolio VaR (see VaRDecomposition.h)
 void CalculateVaRDecomposition(double* assetReturns, double* weights, int numAssets, int length, 
                               double confidenceLevel, double* contributions);
 
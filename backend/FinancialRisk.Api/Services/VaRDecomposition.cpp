@@ -0,0 +1,123 @@
+#include "VaRDecomposition.h"
+#include "QuantileKernels.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Observations per portfolio P&L chunk; the chunk stays in cache while
+    // every asset row is added into it
+    const int TimeChunk = 1024;
+    // Assets per worker chunk in the scenario read pass
+    const int AssetGrain = 64;
+    // Kernel support, in bandwidths
+    const double KernelReach = 4.0;
+    
+    // Portfolio return per observation
+    void portfolioReturns(const double* assetReturns, const double* weights, int numAssets, int length,
+                          double* portfolio) {
+        RiskKernels::parallelFor(length, TimeChunk, [&](int begin, int end) {
+            std::fill(portfolio + begin, portfolio + end, 0.0);
+            for (int j = 0; j < numAssets; ++j) {
+                const double weight = weights[j];
+                const double* row = assetReturns + static_cast<size_t>(j) * length;
+                for (int t = begin; t < end; ++t) {
+                    portfolio[t] += weight * row[t];
+                }
+            }
+        });
+    }
+    
+    // A scenario and the weights it carries in the VaR and ES averages
+    struct Scenario {
+        int time;
+        double varWeight;
+        double esWeight;
+    };
+}
+
+extern "C" {
+    // Euler decomposition of historical VaR/ES
+    void CalculateEulerVaRDecomposition(double* assetReturns, double* weights, int numAssets, int length,
+                                        double confidenceLevel, double bandwidth,
+                                        double* portfolioVaR, double* portfolioES,
+                                        double* marginalVaR, double* componentVaR,
+                                        double* marginalES, double* componentES) {
+        if (assetReturns == nullptr || weights == nullptr || numAssets <= 0 || length < 2) return;
+        if (confidenceLevel <= 0.0 || confidenceLevel >= 1.0) return;
+        
+        std::vector<double> portfolio(length);
+        portfolioReturns(assetReturns, weights, numAssets, length, portfolio.data());
+        
+        // Rank scenarios by portfolio return; ties go to the earlier scenario so
+        // the result is deterministic
+        const int index = RiskKernels::historicalVaRIndex(confidenceLevel, length);
+        const int tailCount = RiskKernels::historicalTailCount(confidenceLevel, length);
+        std::vector<int> order(length);
+        for (int t = 0; t < length; ++t) order[t] = t;
+        auto lower = [&](int a, int b) {
+            return portfolio[a] < portfolio[b] || (portfolio[a] == portfolio[b] && a < b);
+        };
+        const int deeper = std::max(index, tailCount - 1);
+        const int shallower = std::min(index, tailCount - 1);
+        std::nth_element(order.begin(), order.begin() + deeper, order.end(), lower);
+        if (shallower < deeper) {
+            std::nth_element(order.begin(), order.begin() + shallower, order.begin() + deeper, lower);
+        }
+        
+        const int varScenario = order[index];
+        const double valueAtRisk = -portfolio[varScenario];
+        
+        // VaR weights: the VaR scenario alone, or a normalized kernel around it
+        std::vector<double> varWeights(length, 0.0);
+        if (bandwidth > 0.0) {
+            const double quantile = portfolio[varScenario];
+            double total = 0.0;
+            for (int t = 0; t < length; ++t) {
+                const double z = (portfolio[t] - quantile) / bandwidth;
+                if (std::abs(z) > KernelReach) continue;
+                varWeights[t] = std::exp(-0.5 * z * z);
+                total += varWeights[t];
+            }
+            for (int t = 0; t < length; ++t) {
+                varWeights[t] /= total;
+            }
+        } else {
+            varWeights[varScenario] = 1.0;
+        }
+        
+        std::vector<double> esWeights(length, 0.0);
+        double tailSum = 0.0;
+        for (int i = 0; i < tailCount; ++i) {
+            esWeights[order[i]] = 1.0 / tailCount;
+            tailSum += portfolio[order[i]];
+        }
+        
+        // Only the scenarios with weight are read from the matrix, in time order
+        std::vector<Scenario> scenarios;
+        for (int t = 0; t < length; ++t) {
+            if (varWeights[t] != 0.0 || esWeights[t] != 0.0) {
+                scenarios.push_back({t, varWeights[t], esWeights[t]});
+            }
+        }
+        
+        if (portfolioVaR) *portfolioVaR = valueAtRisk;
+        if (portfolioES) *portfolioES = -(tailSum / tailCount);
+        
+        RiskKernels::parallelFor(numAssets, AssetGrain, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                const double* row = assetReturns + static_cast<size_t>(j) * length;
+                double varSum = 0.0, esSum = 0.0;
+                for (const Scenario& scenario : scenarios) {
+                    varSum += scenario.varWeight * row[scenario.time];
+                    esSum += scenario.esWeight * row[scenario.time];
+                }
+                if (marginalVaR) marginalVaR[j] = -varSum;
+                if (componentVaR) componentVaR[j] = -weights[j] * varSum;
+                if (marginalES) marginalES[j] = -esSum;
+                if (componentES) componentES[j] = -weights[j] * esSum;
+            }
+        });
+    }
+}
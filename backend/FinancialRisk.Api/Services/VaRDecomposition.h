@@ -0,0 +1,41 @@
+#ifndef VAR_DECOMPOSITION_H
+#define VAR_DECOMPOSITION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Euler allocation of historical portfolio VaR and ES to the assets.
+//
+// assetReturns holds numAssets series of length observations, one after another
+// (as in CalculateVaRDecomposition). The portfolio P&L is formed in one blocked
+// pass; its VaR scenario and ES tail scenarios are located once by selection.
+// Each asset's marginal figures are then read from those scenarios only:
+//   marginalVaR[j] = -r_j(t*) at the VaR scenario t*
+//   marginalES[j]  = -mean of r_j over the ES tail scenarios
+// and componentX[j] = weights[j] * marginalX[j], so the components sum to the
+// portfolio figures.
+//
+// With bandwidth > 0 the single VaR scenario is replaced by a Gaussian kernel
+// over the scenarios whose portfolio return lies within 4 bandwidths of the VaR
+// quantile (bandwidth is in return units), and marginalVaR[j] is the kernel
+// estimate -sum_t k_t r_j(t) / sum_t k_t. That reduces the noise of a
+// one-scenario estimate. The components then add up to the kernel-smoothed
+// portfolio VaR, -sum_t k_t r_p(t) / sum_t k_t, which differs from portfolioVaR
+// by the smoothing; a bandwidth that is small next to the spread of the
+// portfolio returns keeps the two close.
+//
+// VaR and ES follow CalculateHistoricalVaR / CalculateHistoricalCVaR. Any output
+// may be null. Nothing is written if length < 2 or confidenceLevel is outside
+// (0, 1).
+void CalculateEulerVaRDecomposition(double* assetReturns, double* weights, int numAssets, int length,
+                                    double confidenceLevel, double bandwidth,
+                                    double* portfolioVaR, double* portfolioES,
+                                    double* marginalVaR, double* componentVaR,
+                                    double* marginalES, double* componentES);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VAR_DECOMPOSITION_H
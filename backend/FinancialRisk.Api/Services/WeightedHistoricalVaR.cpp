@@ -0,0 +1,154 @@
+#include "WeightedHistoricalVaR.h"
+#include "QuantileKernels.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Valid confidence levels of a call, with the output column of each
+    struct LevelSet {
+        std::vector<double> levels;
+        std::vector<int> positions;
+    };
+    
+    // Zero the outputs and collect the valid levels (none if the series is too short)
+    LevelSet prepareOutputs(int length, int numLambdas, const double* confidenceLevels, int numLevels,
+                            double* valueAtRisk, double* expectedShortfall) {
+        const size_t total = static_cast<size_t>(numLambdas) * numLevels;
+        if (valueAtRisk) std::fill(valueAtRisk, valueAtRisk + total, 0.0);
+        if (expectedShortfall) std::fill(expectedShortfall, expectedShortfall + total, 0.0);
+        
+        LevelSet set;
+        for (int level = 0; level < numLevels; ++level) {
+            if (length >= 2 && confidenceLevels[level] > 0.0 && confidenceLevels[level] < 1.0) {
+                set.levels.push_back(confidenceLevels[level]);
+                set.positions.push_back(level);
+            }
+        }
+        return set;
+    }
+    
+    bool validLambda(double lambda) {
+        return lambda > 0.0 && lambda <= 1.0;
+    }
+    
+    // Weighted VaR and ES of values visited in ascending order (values[i] has
+    // weight weights[i], weights summing to one). levelOrder lists the levels
+    // by tail mass, smallest first, so one walk serves them all.
+    void weightedTailLevels(const double* values, const double* weights, int length,
+                            const std::vector<double>& tailMass, const std::vector<int>& levelOrder,
+                            double* var, double* es) {
+        double cumulative = 0.0, tailSum = 0.0;
+        size_t next = 0;
+        for (int i = 0; i < length && next < levelOrder.size(); ++i) {
+            const double before = cumulative;
+            cumulative += weights[i];
+            while (next < levelOrder.size() && (cumulative > tailMass[levelOrder[next]] || i == length - 1)) {
+                const int level = levelOrder[next++];
+                const double alpha = tailMass[level];
+                var[level] = -values[i];
+                es[level] = -(tailSum + (alpha - before) * values[i]) / alpha;
+            }
+            tailSum += weights[i] * values[i];
+        }
+    }
+}
+
+extern "C" {
+    // Age-weighted (BRW) historical VaR/ES for several lambdas and levels
+    void CalculateAgeWeightedVaR(double* returns, int length, double* lambdas, int numLambdas,
+                                 double* confidenceLevels, int numLevels,
+                                 double* valueAtRisk, double* expectedShortfall) {
+        if (returns == nullptr || lambdas == nullptr || confidenceLevels == nullptr) return;
+        if (numLambdas <= 0 || numLevels <= 0) return;
+        LevelSet set = prepareOutputs(length, numLambdas, confidenceLevels, numLevels, valueAtRisk, expectedShortfall);
+        if (set.levels.empty()) return;
+        
+        // One sort shared by every lambda; ties keep chronological order
+        std::vector<int> order(length);
+        for (int t = 0; t < length; ++t) order[t] = t;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return returns[a] < returns[b] || (returns[a] == returns[b] && a < b);
+        });
+        std::vector<double> sorted(length);
+        for (int i = 0; i < length; ++i) sorted[i] = returns[order[i]];
+        
+        const int valid = static_cast<int>(set.levels.size());
+        std::vector<double> tailMass(valid);
+        std::vector<int> levelOrder(valid);
+        for (int l = 0; l < valid; ++l) {
+            tailMass[l] = 1.0 - set.levels[l];
+            levelOrder[l] = l;
+        }
+        std::sort(levelOrder.begin(), levelOrder.end(), [&](int a, int b) { return tailMass[a] < tailMass[b]; });
+        
+        std::vector<double> ageWeights(length), sortedWeights(length);
+        std::vector<double> var(valid), es(valid);
+        for (int k = 0; k < numLambdas; ++k) {
+            const double lambda = lambdas[k];
+            if (!validLambda(lambda)) continue;
+            
+            // lambda^age, normalized; the most recent observation has age 0
+            double power = 1.0, total = 0.0;
+            for (int t = length - 1; t >= 0; --t) {
+                ageWeights[t] = power;
+                total += power;
+                power *= lambda;
+            }
+            for (int i = 0; i < length; ++i) {
+                sortedWeights[i] = ageWeights[order[i]] / total;
+            }
+            
+            weightedTailLevels(sorted.data(), sortedWeights.data(), length, tailMass, levelOrder,
+                               var.data(), es.data());
+            const size_t row = static_cast<size_t>(k) * numLevels;
+            for (int l = 0; l < valid; ++l) {
+                if (valueAtRisk) valueAtRisk[row + set.positions[l]] = var[l];
+                if (expectedShortfall) expectedShortfall[row + set.positions[l]] = es[l];
+            }
+        }
+    }
+    
+    // Volatility-weighted (Hull-White) historical VaR/ES for several lambdas and levels
+    void CalculateVolatilityWeightedVaR(double* returns, int length, double* lambdas, int numLambdas,
+                                        double* confidenceLevels, int numLevels,
+                                        double* valueAtRisk, double* expectedShortfall) {
+        if (returns == nullptr || lambdas == nullptr || confidenceLevels == nullptr) return;
+        if (numLambdas <= 0 || numLevels <= 0) return;
+        LevelSet set = prepareOutputs(length, numLambdas, confidenceLevels, numLevels, valueAtRisk, expectedShortfall);
+        if (set.levels.empty()) return;
+        
+        double mean = 0.0;
+        for (int t = 0; t < length; ++t) mean += returns[t];
+        mean /= length;
+        double seedVariance = 0.0;
+        for (int t = 0; t < length; ++t) seedVariance += (returns[t] - mean) * (returns[t] - mean);
+        seedVariance /= (length - 1);
+        
+        const int valid = static_cast<int>(set.levels.size());
+        std::vector<double> variance(length), scaled(length);
+        std::vector<double> var(valid), es(valid);
+        for (int k = 0; k < numLambdas; ++k) {
+            const double lambda = lambdas[k];
+            if (!validLambda(lambda)) continue;
+            
+            // variance[t] is the forecast made before return t; current is the one after the last return
+            double current = seedVariance;
+            for (int t = 0; t < length; ++t) {
+                variance[t] = current;
+                current = lambda * current + (1.0 - lambda) * returns[t] * returns[t];
+            }
+            for (int t = 0; t < length; ++t) {
+                scaled[t] = variance[t] > 0.0 ? returns[t] * std::sqrt(current / variance[t]) : returns[t];
+            }
+            
+            int maxTail = RiskKernels::selectVaRLevels(scaled.data(), length, set.levels.data(), valid, var.data());
+            RiskKernels::tailAveragesOfLevels(scaled.data(), length, set.levels.data(), valid, maxTail, es.data());
+            const size_t row = static_cast<size_t>(k) * numLevels;
+            for (int l = 0; l < valid; ++l) {
+                if (valueAtRisk) valueAtRisk[row + set.positions[l]] = var[l];
+                if (expectedShortfall) expectedShortfall[row + set.positions[l]] = es[l];
+            }
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef WEIGHTED_HISTORICAL_VAR_H
+#define WEIGHTED_HISTORICAL_VAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Weighted historical simulation. returns are in chronological order (the last
+// element is the most recent). Both functions evaluate numLambdas decay
+// factors and numLevels confidence levels in one call; valueAtRisk and
+// expectedShortfall receive numLambdas x numLevels values (row per lambda).
+// Lambdas outside (0, 1] and levels outside (0, 1) report 0, as do series
+// shorter than 2. Either output may be null.
+
+// Age-weighted (Boudoukh-Richardson-Whitelaw) VaR and ES. The observation of
+// age a (0 = most recent) gets weight lambda^a (1 - lambda) / (1 - lambda^n);
+// lambda = 1 gives equal weights. The returns are sorted once and the sorted
+// permutation is shared by every lambda and level: each lambda is a single
+// cumulative-weight walk from the worst return until the deepest level's tail
+// mass 1 - c is covered. VaR is the first sorted return whose cumulative
+// weight exceeds 1 - c; ES is the weighted mean of the worst 1 - c of
+// probability mass, splitting the boundary observation's weight.
+void CalculateAgeWeightedVaR(double* returns, int length, double* lambdas, int numLambdas,
+                             double* confidenceLevels, int numLevels,
+                             double* valueAtRisk, double* expectedShortfall);
+
+// Volatility-weighted (Hull-White) VaR and ES. Each return is rescaled by the
+// ratio of the current EWMA volatility to the EWMA volatility when it
+// occurred, sigma_t^2 = lambda sigma_{t-1}^2 + (1 - lambda) r_{t-1}^2, seeded
+// with the sample variance. VaR and ES of the rescaled series follow
+// CalculateHistoricalVaR / CalculateHistoricalCVaR.
+void CalculateVolatilityWeightedVaR(double* returns, int length, double* lambdas, int numLambdas,
+                                    double* confidenceLevels, int numLevels,
+                                    double* valueAtRisk, double* expectedShortfall);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEIGHTED_HISTORICAL_VAR_H
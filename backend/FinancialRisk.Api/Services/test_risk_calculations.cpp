@@ -2,7 +2,13 @@
 #include <vector>
 #include <cmath>
 #include <cassert>
+#include <chrono>
+#include <algorithm>
 #include "RiskCalculations.h"
+#include "RollingRisk.h"
+#include "RiskAccumulator.h"
+#include "Drawdown.h"
+#include "FactorRegression.h"
 
 // Test data
 std::vector<double> testReturns = {
@@ -129,6 +135,455 @@ void testInformationRatio() {
     std::cout << "✅ Information Ratio test passed: " << infoRatio << "\n";
 }
 
+// Test fused risk profile against the individual functions
+void testRiskProfile() {
+    std::cout << "Testing risk profile calculation...\n";
+    
+    int length = static_cast<int>(testReturns.size());
+    RiskProfile profile;
+    CalculateRiskProfile(testReturns.data(), benchmarkReturns.data(), 0.02, length, &profile);
+    
+    assert(approximatelyEqual(profile.volatility, CalculateVolatility(testReturns.data(), length), 1e-12));
+    assert(approximatelyEqual(profile.beta, CalculateBeta(testReturns.data(), benchmarkReturns.data(), length), 1e-9));
+    assert(approximatelyEqual(profile.sharpeRatio, CalculateSharpeRatio(testReturns.data(), 0.02, length), 1e-9));
+    assert(approximatelyEqual(profile.sortinoRatio, CalculateSortinoRatio(testReturns.data(), 0.02, length), 1e-9));
+    assert(profile.valueAtRisk95 == CalculateValueAtRisk(testReturns.data(), 0.95, length));
+    assert(profile.valueAtRisk99 == CalculateValueAtRisk(testReturns.data(), 0.99, length));
+    assert(approximatelyEqual(profile.expectedShortfall95, CalculateExpectedShortfall(testReturns.data(), 0.95, length), 1e-12));
+    assert(approximatelyEqual(profile.expectedShortfall99, CalculateExpectedShortfall(testReturns.data(), 0.99, length), 1e-12));
+    assert(approximatelyEqual(profile.maximumDrawdown, CalculateMaximumDrawdown(testReturns.data(), length), 1e-12));
+    assert(approximatelyEqual(profile.informationRatio, CalculateInformationRatio(testReturns.data(), benchmarkReturns.data(), length), 1e-9));
+    
+    // Larger series so the 95% and 99% tails differ
+    std::vector<double> longReturns(1000);
+    for (int i = 0; i < 1000; ++i) {
+        longReturns[i] = 0.02 * std::sin(i * 0.37) + 0.001 * (i % 7) - 0.003;
+    }
+    CalculateRiskProfile(longReturns.data(), nullptr, 0.02, 1000, &profile);
+    assert(profile.beta == 0.0 && profile.informationRatio == 0.0);
+    assert(profile.valueAtRisk95 == CalculateValueAtRisk(longReturns.data(), 0.95, 1000));
+    assert(profile.valueAtRisk99 == CalculateValueAtRisk(longReturns.data(), 0.99, 1000));
+    assert(approximatelyEqual(profile.expectedShortfall95, CalculateExpectedShortfall(longReturns.data(), 0.95, 1000), 1e-12));
+    assert(approximatelyEqual(profile.expectedShortfall99, CalculateExpectedShortfall(longReturns.data(), 0.99, 1000), 1e-12));
+    assert(approximatelyEqual(profile.sortinoRatio, CalculateSortinoRatio(longReturns.data(), 0.02, 1000), 1e-9));
+    
+    std::cout << "✅ Risk profile test passed: Volatility = " << profile.volatility
+              << ", 99% ES = " << profile.expectedShortfall99 << "\n";
+}
+
+// Test SIMD moment kernels against the scalar reference path
+void testMomentKernelIsa() {
+    std::cout << "Testing SIMD moment kernels...\n";
+    
+    const int defaultIsa = GetMomentKernelIsa();
+    const int lengths[] = {2, 3, 7, 17, 33, 250, 10007};
+    
+    // Deterministic pseudo-random series
+    std::vector<double> asset(10007), benchmark(10007);
+    unsigned int state = 12345u;
+    for (int i = 0; i < 10007; ++i) {
+        state = state * 1664525u + 1013904223u;
+        benchmark[i] = (static_cast<int>(state >> 8) % 2001 - 1000) * 2e-5 + 0.0003;
+        state = state * 1664525u + 1013904223u;
+        asset[i] = 1.2 * benchmark[i] + (static_cast<int>(state >> 8) % 2001 - 1000) * 1e-5;
+    }
+    
+    auto relativelyEqual = [](double a, double b) {
+        return std::abs(a - b) <= 1e-12 * std::max(1.0, std::abs(b));
+    };
+    
+    for (int isa = 1; isa <= 2; ++isa) {
+        for (int length : lengths) {
+            SetMomentKernelIsa(0);
+            double vol = CalculateVolatility(asset.data(), length);
+            double beta = CalculateBeta(asset.data(), benchmark.data(), length);
+            double infoRatio = CalculateInformationRatio(asset.data(), benchmark.data(), length);
+            
+            if (SetMomentKernelIsa(isa) != isa) break; // not supported on this CPU
+            assert(relativelyEqual(CalculateVolatility(asset.data(), length), vol));
+            assert(relativelyEqual(CalculateBeta(asset.data(), benchmark.data(), length), beta));
+            assert(relativelyEqual(CalculateInformationRatio(asset.data(), benchmark.data(), length), infoRatio));
+        }
+    }
+    
+    SetMomentKernelIsa(defaultIsa);
+    assert(GetMomentKernelIsa() == defaultIsa);
+    
+    std::cout << "✅ SIMD moment kernel test passed: active ISA = " << defaultIsa << "\n";
+}
+
+// Test cross-sectional batch metrics against the single-series functions
+void testBatchRiskMetrics() {
+    std::cout << "Testing batch risk metrics...\n";
+    
+    const int numObservations = 300, numAssets = 37, paddedStride = 40;
+    std::vector<double> rowMajor(numObservations * paddedStride, 99.0);
+    std::vector<double> columnMajor(numAssets * numObservations);
+    unsigned int state = 777u;
+    for (int t = 0; t < numObservations; ++t) {
+        for (int j = 0; j < numAssets; ++j) {
+            state = state * 1664525u + 1013904223u;
+            double value = (static_cast<int>(state >> 8) % 2001 - 1000) * (1e-5 * (1 + j % 5));
+            rowMajor[t * paddedStride + j] = value;
+            columnMajor[j * numObservations + t] = value;
+        }
+    }
+    
+    std::vector<double> vol(numAssets), sharpe(numAssets), sortino(numAssets);
+    std::vector<double> var(numAssets), es(numAssets), mdd(numAssets);
+    std::vector<double> rowVar(numAssets), rowMdd(numAssets);
+    
+    CalculateBatchRiskMetrics(columnMajor.data(), numObservations, numAssets, 0, RISK_LAYOUT_COLUMN_MAJOR, 0.02, 0.95,
+                              vol.data(), sharpe.data(), sortino.data(), var.data(), es.data(), mdd.data());
+    CalculateBatchRiskMetrics(rowMajor.data(), numObservations, numAssets, paddedStride, RISK_LAYOUT_ROW_MAJOR, 0.02, 0.95,
+                              nullptr, nullptr, nullptr, rowVar.data(), nullptr, rowMdd.data());
+    
+    for (int j = 0; j < numAssets; ++j) {
+        double* series = columnMajor.data() + j * numObservations;
+        assert(approximatelyEqual(vol[j], CalculateVolatility(series, numObservations), 1e-12));
+        assert(approximatelyEqual(sharpe[j], CalculateSharpeRatio(series, 0.02, numObservations), 1e-9));
+        assert(approximatelyEqual(sortino[j], CalculateSortinoRatio(series, 0.02, numObservations), 1e-9));
+        assert(var[j] == CalculateValueAtRisk(series, 0.95, numObservations));
+        assert(approximatelyEqual(es[j], CalculateExpectedShortfall(series, 0.95, numObservations), 1e-12));
+        assert(approximatelyEqual(mdd[j], CalculateMaximumDrawdown(series, numObservations), 1e-12));
+        assert(rowVar[j] == var[j]);
+        assert(rowMdd[j] == mdd[j]);
+    }
+    
+    std::cout << "✅ Batch risk metrics test passed for " << numAssets << " assets\n";
+}
+
+// Test shared-benchmark metrics against the single-series functions
+void testBenchmarkRelativeMetrics() {
+    std::cout << "Testing benchmark-relative batch metrics...\n";
+    
+    const int numObservations = 500, numAssets = 70;
+    std::vector<double> benchmark(numObservations);
+    std::vector<double> rowMajor(numObservations * numAssets), columnMajor(numAssets * numObservations);
+    for (int t = 0; t < numObservations; ++t) {
+        benchmark[t] = 0.01 * std::sin(t * 0.29) + 0.0003;
+        for (int j = 0; j < numAssets; ++j) {
+            double value = (0.5 + 0.02 * j) * benchmark[t] + 0.005 * std::sin(t * (0.7 + 0.01 * j) + j);
+            rowMajor[t * numAssets + j] = value;
+            columnMajor[j * numObservations + t] = value;
+        }
+    }
+    
+    const double riskFreeRate = 0.02;
+    std::vector<double> beta(numAssets), correlation(numAssets), te(numAssets), infoRatio(numAssets), alpha(numAssets);
+    std::vector<double> rowBeta(numAssets), rowCorrelation(numAssets), rowTe(numAssets), rowInfoRatio(numAssets),
+                        rowAlpha(numAssets);
+    CalculateBenchmarkRelativeMetrics(benchmark.data(), columnMajor.data(), numObservations, numAssets, 0,
+                                      RISK_LAYOUT_COLUMN_MAJOR, riskFreeRate, beta.data(), correlation.data(), te.data(),
+                                      infoRatio.data(), alpha.data());
+    CalculateBenchmarkRelativeMetrics(benchmark.data(), rowMajor.data(), numObservations, numAssets, 0,
+                                      RISK_LAYOUT_ROW_MAJOR, riskFreeRate, rowBeta.data(), rowCorrelation.data(),
+                                      rowTe.data(), rowInfoRatio.data(), rowAlpha.data());
+    
+    // Two-pass reference for correlation, tracking error and alpha
+    const double n = numObservations;
+    double benchmarkMean = 0.0;
+    for (int t = 0; t < numObservations; ++t) benchmarkMean += benchmark[t];
+    benchmarkMean /= n;
+    for (int j = 0; j < numAssets; ++j) {
+        double* series = columnMajor.data() + j * numObservations;
+        double assetMean = 0.0, excessMean = 0.0;
+        for (int t = 0; t < numObservations; ++t) {
+            assetMean += series[t];
+            excessMean += series[t] - benchmark[t];
+        }
+        assetMean /= n;
+        excessMean /= n;
+        double covariance = 0.0, assetVariance = 0.0, benchmarkVariance = 0.0, excessVariance = 0.0;
+        for (int t = 0; t < numObservations; ++t) {
+            double a = series[t] - assetMean, b = benchmark[t] - benchmarkMean;
+            double e = series[t] - benchmark[t] - excessMean;
+            covariance += a * b;
+            assetVariance += a * a;
+            benchmarkVariance += b * b;
+            excessVariance += e * e;
+        }
+        double expectedBeta = CalculateBeta(series, benchmark.data(), numObservations);
+        double expectedInfoRatio = CalculateInformationRatio(series, benchmark.data(), numObservations);
+        double expectedCorrelation = covariance / std::sqrt(assetVariance * benchmarkVariance);
+        double expectedTe = std::sqrt(excessVariance / (n - 1)) * std::sqrt(252.0);
+        double expectedAlpha = (assetMean * 252.0 - riskFreeRate)
+                             - covariance / benchmarkVariance * (benchmarkMean * 252.0 - riskFreeRate);
+        
+        assert(approximatelyEqual(beta[j], expectedBeta, 1e-10));
+        assert(approximatelyEqual(infoRatio[j], expectedInfoRatio, 1e-9));
+        assert(approximatelyEqual(correlation[j], expectedCorrelation, 1e-10));
+        assert(approximatelyEqual(te[j], expectedTe, 1e-10));
+        assert(approximatelyEqual(alpha[j], expectedAlpha, 1e-10));
+        assert(approximatelyEqual(rowBeta[j], expectedBeta, 1e-10));
+        assert(approximatelyEqual(rowInfoRatio[j], expectedInfoRatio, 1e-9));
+        assert(approximatelyEqual(rowCorrelation[j], expectedCorrelation, 1e-10));
+        assert(approximatelyEqual(rowTe[j], expectedTe, 1e-10));
+        assert(approximatelyEqual(rowAlpha[j], expectedAlpha, 1e-10));
+    }
+    
+    std::cout << "✅ Benchmark-relative metrics test passed: beta[0] = " << beta[0] << ", alpha[0] = " << alpha[0] << "\n";
+}
+
+// Test drawdown analytics against direct calculations
+void testDrawdownAnalytics() {
+    std::cout << "Testing drawdown analytics...\n";
+    
+    // Peak after index 1, trough at index 4, recovery at index 6
+    double path[] = {0.02, 0.01, -0.03, -0.02, -0.01, 0.04, 0.03, -0.01};
+    DrawdownAnalytics analytics;
+    CalculateDrawdownAnalytics(path, 8, DRAWDOWN_ADDITIVE, 0, &analytics, nullptr);
+    assert(approximatelyEqual(analytics.maximumDrawdown, CalculateMaximumDrawdown(path, 8), 1e-15));
+    assert(approximatelyEqual(analytics.maximumDrawdown, 0.06, 1e-15));
+    assert(analytics.peakIndex == 1 && analytics.troughIndex == 4 && analytics.recoveryIndex == 6);
+    assert(analytics.longestUnderwaterDuration == 4);
+    assert(analytics.calmarRatio > 0.0 && analytics.ulcerIndex > 0.0);
+    
+    const int length = 600, window = 60;
+    std::vector<double> returns(length);
+    for (int i = 0; i < length; ++i) {
+        returns[i] = 0.02 * std::sin(i * 0.173) + 0.01 * std::cos(i * 0.71) + 0.0002;
+    }
+    
+    for (int mode : {DRAWDOWN_ADDITIVE, DRAWDOWN_COMPOUNDED}) {
+        std::vector<double> rolling(length);
+        CalculateDrawdownAnalytics(returns.data(), length, mode, window, &analytics, rolling.data());
+        
+        // Quadratic reference over each window, starting from the level before it
+        for (int t = 0; t < length; ++t) {
+            if (t + 1 < window) {
+                assert(std::isnan(rolling[t]));
+                continue;
+            }
+            double level = mode == DRAWDOWN_COMPOUNDED ? 1.0 : 0.0;
+            double peak = level, expected = 0.0;
+            for (int i = t - window + 1; i <= t; ++i) {
+                level = mode == DRAWDOWN_COMPOUNDED ? level * (1.0 + returns[i]) : level + returns[i];
+                peak = std::max(peak, level);
+                expected = std::max(expected, mode == DRAWDOWN_COMPOUNDED ? 1.0 - level / peak : peak - level);
+            }
+            assert(approximatelyEqual(rolling[t], expected, 1e-12));
+        }
+        
+        // Full-series drawdown equals a rolling window spanning the whole series
+        std::vector<double> full(length);
+        CalculateDrawdownAnalytics(returns.data(), length, mode, length, nullptr, full.data());
+        assert(approximatelyEqual(full[length - 1], analytics.maximumDrawdown, 1e-12));
+    }
+    
+    std::cout << "✅ Drawdown analytics test passed: max drawdown = " << analytics.maximumDrawdown
+              << ", Ulcer = " << analytics.ulcerIndex << "\n";
+}
+
+// Test float32 batch variants against the double path on the same data
+void testFloatBatchMetrics() {
+    std::cout << "Testing float32 batch metrics...\n";
+    
+    const int numObservations = 1000, numAssets = 20;
+    std::vector<float> columnMajor(numAssets * numObservations), benchmark(numObservations);
+    std::vector<double> widened(columnMajor.size()), widenedBenchmark(numObservations);
+    for (int t = 0; t < numObservations; ++t) {
+        benchmark[t] = static_cast<float>(0.01 * std::sin(t * 0.37) + 0.0004);
+        widenedBenchmark[t] = benchmark[t];
+        for (int j = 0; j < numAssets; ++j) {
+            float value = static_cast<float>(0.8 * benchmark[t] + 0.012 * std::cos(t * (0.11 + 0.03 * j) + j));
+            columnMajor[j * numObservations + t] = value;
+            widened[j * numObservations + t] = value;
+        }
+    }
+    
+    std::vector<double> volF(numAssets), varF(numAssets), esF(numAssets), vol(numAssets), var(numAssets), es(numAssets);
+    CalculateBatchRiskMetricsFloat(columnMajor.data(), numObservations, numAssets, 0, RISK_LAYOUT_COLUMN_MAJOR,
+                                   0.02, 0.95, volF.data(), nullptr, nullptr, varF.data(), esF.data(), nullptr);
+    CalculateBatchRiskMetrics(widened.data(), numObservations, numAssets, 0, RISK_LAYOUT_COLUMN_MAJOR,
+                              0.02, 0.95, vol.data(), nullptr, nullptr, var.data(), es.data(), nullptr);
+    
+    std::vector<double> betaF(numAssets), beta(numAssets);
+    CalculateBenchmarkRelativeMetricsFloat(benchmark.data(), columnMajor.data(), numObservations, numAssets, 0,
+                                           RISK_LAYOUT_COLUMN_MAJOR, 0.02, betaF.data(), nullptr, nullptr, nullptr, nullptr);
+    CalculateBenchmarkRelativeMetrics(widenedBenchmark.data(), widened.data(), numObservations, numAssets, 0,
+                                      RISK_LAYOUT_COLUMN_MAJOR, 0.02, beta.data(), nullptr, nullptr, nullptr, nullptr);
+    
+    for (int j = 0; j < numAssets; ++j) {
+        assert(approximatelyEqual(volF[j], vol[j], 1e-12 * vol[j]));
+        assert(varF[j] == var[j]);
+        assert(approximatelyEqual(esF[j], es[j], 1e-14));
+        assert(approximatelyEqual(betaF[j], beta[j], 1e-12));
+    }
+    
+    std::cout << "✅ Float32 batch metrics test passed\n";
+}
+
+// Test multi-factor exposures against known loadings and the single-factor beta,
+// at the 5,000 assets x 10 factors x 2,520 days size the engine is sized for
+void testFactorExposures() {
+    std::cout << "Testing multi-factor exposures...\n";
+    
+    const int numObservations = 2520, numFactors = 10, numAssets = 5000;
+    std::vector<double> factors(numFactors * numObservations), assets(numAssets * numObservations);
+    std::vector<double> loadings(numAssets * numFactors);
+    for (int p = 0; p < numFactors; ++p) {
+        for (int t = 0; t < numObservations; ++t) {
+            factors[p * numObservations + t] = 0.01 * std::sin(t * (0.05 + 0.071 * p) + p) + 0.0001 * p;
+        }
+    }
+    for (int j = 0; j < numAssets; ++j) {
+        for (int p = 0; p < numFactors; ++p) {
+            loadings[j * numFactors + p] = std::cos(0.37 * j + 1.3 * p);
+        }
+        for (int t = 0; t < numObservations; ++t) {
+            double value = 0.0002 * (j % 5);
+            for (int p = 0; p < numFactors; ++p) {
+                value += loadings[j * numFactors + p] * factors[p * numObservations + t];
+            }
+            assets[j * numObservations + t] = value;
+        }
+    }
+    
+    std::vector<double> alpha(numAssets), betas(numAssets * numFactors), residualVol(numAssets), rSquared(numAssets);
+    auto start = std::chrono::high_resolution_clock::now();
+    int ok = CalculateFactorExposures(assets.data(), factors.data(), numObservations, numAssets, numFactors,
+                                      alpha.data(), betas.data(), residualVol.data(), rSquared.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    assert(ok == 1);
+    
+    // Noise-free assets: loadings and intercepts are recovered exactly
+    for (int j = 0; j < numAssets; ++j) {
+        for (int p = 0; p < numFactors; ++p) {
+            assert(approximatelyEqual(betas[j * numFactors + p], loadings[j * numFactors + p], 1e-7));
+        }
+        assert(approximatelyEqual(alpha[j], 0.0002 * (j % 5), 1e-10));
+        assert(approximatelyEqual(rSquared[j], 1.0, 1e-9));
+        assert(residualVol[j] < 1e-6);
+    }
+    
+    // One factor reduces to CalculateBeta
+    double singleBeta = 0.0, singleRSquared = 0.0;
+    ok = CalculateFactorExposures(testReturns.data(), benchmarkReturns.data(), testReturns.size(), 1, 1,
+                                  nullptr, &singleBeta, nullptr, &singleRSquared);
+    assert(ok == 1);
+    assert(approximatelyEqual(singleBeta, CalculateBeta(testReturns.data(), benchmarkReturns.data(), testReturns.size()), 1e-12));
+    assert(singleRSquared >= 0.0 && singleRSquared <= 1.0);
+    
+    // Collinear factors are rejected
+    std::vector<double> collinear(factors.begin(), factors.begin() + numObservations);
+    collinear.insert(collinear.end(), factors.begin(), factors.begin() + numObservations);
+    ok = CalculateFactorExposures(assets.data(), collinear.data(), numObservations, 1, 2,
+                                  alpha.data(), betas.data(), nullptr, nullptr);
+    assert(ok == 0 && alpha[0] == 0.0 && betas[0] == 0.0 && betas[1] == 0.0);
+    
+    std::cout << "✅ Multi-factor exposures test passed: " << numAssets << " assets x " << numFactors
+              << " factors x " << numObservations << " days in " << duration.count() << " ms\n";
+}
+
+// Test rolling metrics against per-window calls to the single-series functions
+void testRollingRiskMetrics() {
+    std::cout << "Testing rolling risk metrics...\n";
+    
+    const int length = 600;
+    std::vector<double> asset(length), benchmark(length);
+    for (int i = 0; i < length; ++i) {
+        benchmark[i] = 0.01 * std::sin(i * 0.71) + 0.0004;
+        asset[i] = 1.3 * benchmark[i] + 0.004 * std::cos(i * 1.37) + 0.0002;
+    }
+    
+    std::vector<int> windows = {5, 63, 252, 1000};
+    const int numWindows = static_cast<int>(windows.size());
+    std::vector<double> vol(numWindows * length), beta(numWindows * length);
+    std::vector<double> sharpe(numWindows * length), infoRatio(numWindows * length);
+    CalculateRollingRiskMetrics(asset.data(), benchmark.data(), length, windows.data(), numWindows, 0.02,
+                                vol.data(), beta.data(), sharpe.data(), infoRatio.data());
+    
+    auto close = [](double a, double b) { return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b)); };
+    for (int w = 0; w < numWindows; ++w) {
+        int window = windows[w];
+        for (int t = 0; t < length; ++t) {
+            int out = w * length + t;
+            if (window > length || t < window - 1) {
+                assert(std::isnan(vol[out]) && std::isnan(beta[out]));
+                continue;
+            }
+            double* a = asset.data() + t - window + 1;
+            double* b = benchmark.data() + t - window + 1;
+            assert(close(vol[out], CalculateVolatility(a, window)));
+            assert(close(beta[out], CalculateBeta(a, b, window)));
+            assert(close(sharpe[out], CalculateSharpeRatio(a, 0.02, window)));
+            assert(close(infoRatio[out], CalculateInformationRatio(a, b, window)));
+        }
+    }
+    
+    std::cout << "✅ Rolling risk metrics test passed: last 63-day volatility = " << vol[2 * length - 1] << "\n";
+}
+
+// Test the streaming accumulator against recomputation over the same window
+void testRiskAccumulator() {
+    std::cout << "Testing streaming risk accumulator...\n";
+    
+    const int length = 400, window = 63;
+    std::vector<double> asset(length), benchmark(length);
+    for (int i = 0; i < length; ++i) {
+        benchmark[i] = 0.012 * std::sin(i * 0.53) + 0.0003;
+        asset[i] = 0.9 * benchmark[i] + 0.006 * std::sin(i * 2.11 + 1.0);
+    }
+    
+    auto close = [](double a, double b) { return std::abs(a - b) <= 1e-8 * std::max(1.0, std::abs(b)); };
+    
+    RiskAccumulator* rolling = CreateRiskAccumulator(window, 1, 0.02, 0.0);
+    RiskAccumulator* expanding = CreateRiskAccumulator(0, 1, 0.02, 0.0);
+    StreamingRiskMetrics metrics;
+    
+    for (int t = 0; t < length; ++t) {
+        AppendRiskObservation(rolling, asset[t], benchmark[t]);
+        AppendRiskObservation(expanding, asset[t], benchmark[t]);
+        
+        int n = std::min(t + 1, window);
+        if (n < 2) continue;
+        double* a = asset.data() + t + 1 - n;
+        double* b = benchmark.data() + t + 1 - n;
+        
+        QueryRiskAccumulator(rolling, &metrics);
+        assert(metrics.count == n);
+        assert(close(metrics.volatility, CalculateVolatility(a, n)));
+        assert(close(metrics.sharpeRatio, CalculateSharpeRatio(a, 0.02, n)));
+        assert(close(metrics.beta, CalculateBeta(a, b, n)));
+        assert(close(metrics.informationRatio, CalculateInformationRatio(a, b, n)));
+        assert(close(metrics.maximumDrawdown, CalculateMaximumDrawdown(a, n)));
+        
+        // Sortino below a zero target
+        double downsideSum = 0.0, mean = 0.0;
+        int downsideCount = 0;
+        for (int i = 0; i < n; ++i) {
+            mean += a[i] / n;
+            if (a[i] < 0.0) {
+                downsideSum += a[i] * a[i];
+                downsideCount++;
+            }
+        }
+        double expectedSortino = downsideCount == 0 ? 0.0
+            : (mean * 252.0 - 0.02) / std::sqrt(downsideSum / downsideCount * 252.0);
+        assert(close(metrics.sortinoRatio, expectedSortino));
+    }
+    
+    QueryRiskAccumulator(expanding, &metrics);
+    assert(metrics.count == length);
+    assert(close(metrics.volatility, CalculateVolatility(asset.data(), length)));
+    assert(close(metrics.maximumDrawdown, CalculateMaximumDrawdown(asset.data(), length)));
+    
+    // Draining the window one observation at a time
+    for (int remaining = window; remaining > 0; --remaining) {
+        assert(RemoveOldestRiskObservation(rolling) == 1);
+    }
+    assert(RemoveOldestRiskObservation(rolling) == 0);
+    QueryRiskAccumulator(rolling, &metrics);
+    assert(metrics.count == 0 && metrics.volatility == 0.0);
+    
+    DestroyRiskAccumulator(rolling);
+    DestroyRiskAccumulator(expanding);
+    
+    std::cout << "✅ Streaming risk accumulator test passed\n";
+}
+
 // Test edge cases
 void testEdgeCases() {
     std::cout << "Testing edge cases...\n";
@@ -191,6 +646,15 @@ int main() {
         testExpectedShortfall();
         testMaximumDrawdown();
         testInformationRatio();
+        testRiskProfile();
+        testMomentKernelIsa();
+        testBatchRiskMetrics();
+        testBenchmarkRelativeMetrics();
+        testDrawdownAnalytics();
+        testFloatBatchMetrics();
+        testFactorExposures();
+        testRollingRiskMetrics();
+        testRiskAccumulator();
         testEdgeCases();
         testPerformance();
         
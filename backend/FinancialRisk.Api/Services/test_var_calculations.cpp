@@ -3,7 +3,23 @@
 #include <cmath>
 #include <cassert>
 #include <chrono>
+#include <algorithm>
+#include <random>
 #include "VaRCalculations.h"
+#include "RollingVaR.h"
+#include "BootstrapVaR.h"
+#include "VaRDecomposition.h"
+#include "PortfolioBatchVaR.h"
+#include "WeightedHistoricalVaR.h"
+#include "FilteredHistoricalVaR.h"
+#include "IncrementalVaR.h"
+#include "ParametricVaR.h"
+#include "MultiHorizonVaR.h"
+#include "VaRBacktest.h"
+#include "ExtremeValueVaR.h"
+#include "SmoothedQuantileVaR.h"
+#include "DistributionKernels.h"
+#include "RandomStreams.h"
 
 // Test data
 std::vector<double> testReturns = {
@@ -47,6 +63,79 @@ void testHistoricalCVaR() {
     std::cout << "✅ Historical CVaR test passed: 95% CVaR = " << cvar95 << ", 99% CVaR = " << cvar99 << "\n";
 }
 
+// Test selection-based historical VaR/CVaR against a full sort
+void testHistoricalVaRSelection() {
+    std::cout << "Testing selection-based historical VaR...\n";
+    
+    const int length = 1000000;
+    std::vector<double> pnl(length);
+    for (int i = 0; i < length; ++i) {
+        // Rounded values so the selected order statistic has ties around it
+        pnl[i] = std::round(1e4 * 0.02 * std::sin(i * 0.618 + std::cos(i * 0.0007))) / 1e4;
+    }
+    std::vector<double> sorted(pnl);
+    std::sort(sorted.begin(), sorted.end());
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (double level : {0.95, 0.99, 0.999}) {
+        int index = static_cast<int>((1.0 - level) * length);
+        double tailSum = 0.0;
+        for (int i = 0; i < index; ++i) tailSum += sorted[i];
+        
+        assert(CalculateHistoricalVaR(pnl.data(), length, level) == -sorted[index]);
+        assert(approximatelyEqual(CalculateHistoricalCVaR(pnl.data(), length, level), -tailSum / index, 1e-12));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    
+    std::cout << "✅ Selection-based historical VaR test passed: 3 levels x 1M scenarios in " << duration.count() << " ms\n";
+}
+
+// Test multi-level VaR/CVaR against the single-level functions
+void testVaRLevels() {
+    std::cout << "Testing multi-level VaR/CVaR...\n";
+    
+    std::vector<double> returns(2000);
+    for (size_t i = 0; i < returns.size(); ++i) {
+        returns[i] = std::round(1e4 * 0.015 * std::sin(i * 1.37 + std::cos(i * 0.01))) / 1e4;
+    }
+    const int length = static_cast<int>(returns.size());
+    
+    // Unordered, duplicated and out-of-range levels
+    std::vector<double> levels = {0.99, 0.9, 0.975, 0.999, 0.95, 0.99, 1.5, 0.0};
+    const int numLevels = static_cast<int>(levels.size());
+    std::vector<double> var(numLevels), cvar(numLevels), pvar(numLevels), pcvar(numLevels);
+    CalculateHistoricalVaRLevels(returns.data(), length, levels.data(), numLevels, var.data(), cvar.data());
+    CalculateParametricVaRLevels(returns.data(), length, levels.data(), numLevels, pvar.data(), pcvar.data());
+    
+    for (int level = 0; level < numLevels; ++level) {
+        assert(var[level] == CalculateHistoricalVaR(returns.data(), length, levels[level]));
+        assert(approximatelyEqual(cvar[level], CalculateHistoricalCVaR(returns.data(), length, levels[level]), 1e-12));
+        assert(pvar[level] == CalculateParametricVaR(returns.data(), length, levels[level]));
+        assert(pcvar[level] == CalculateParametricCVaR(returns.data(), length, levels[level]));
+    }
+    assert(var[6] == 0.0 && cvar[7] == 0.0);
+    
+    std::cout << "✅ Multi-level VaR/CVaR test passed: 99.9% VaR = " << var[3] << ", CVaR = " << cvar[3] << "\n";
+}
+
+// Test float32 historical VaR/CVaR against the double path on the same values
+void testFloatHistoricalVaR() {
+    std::cout << "Testing float32 historical VaR...\n";
+    
+    std::vector<float> floatReturns(testReturns.begin(), testReturns.end());
+    std::vector<double> widened(floatReturns.begin(), floatReturns.end());
+    for (double level : {0.9, 0.95, 0.99}) {
+        double var = CalculateHistoricalVaRFloat(floatReturns.data(), floatReturns.size(), level);
+        double cvar = CalculateHistoricalCVaRFloat(floatReturns.data(), floatReturns.size(), level);
+        assert(var == CalculateHistoricalVaR(widened.data(), widened.size(), level));
+        assert(approximatelyEqual(cvar, CalculateHistoricalCVaR(widened.data(), widened.size(), level), 1e-15));
+        assert(approximatelyEqual(var, CalculateHistoricalVaR(testReturns.data(), testReturns.size(), level), 1e-8));
+    }
+    
+    std::cout << "✅ Float32 historical VaR test passed\n";
+}
+
 // Test parametric VaR calculation
 void testParametricVaR() {
     std::cout << "Testing parametric VaR calculation...\n";
@@ -92,6 +181,147 @@ void testBootstrapVaR() {
     std::cout << "✅ Bootstrap VaR test passed: 95% VaR = " << var95 << ", 99% VaR = " << var99 << "\n";
 }
 
+// Test the seeded bootstrap engine for reproducibility and speed
+void testSeededBootstrap() {
+    std::cout << "Testing seeded bootstrap engine...\n";
+    
+    const int length = 2500, replicates = 10000;
+    std::vector<double> history(length);
+    for (int i = 0; i < length; ++i) {
+        history[i] = 0.012 * std::sin(i * 0.73 + std::cos(i * 0.031)) + 0.004 * std::cos(i * 2.9);
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    double lower = 0.0, upper = 0.0;
+    CalculateVaRConfidenceIntervalsSeeded(history.data(), length, 0.99, replicates, 42, &lower, &upper);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    
+    // Same seed reproduces exactly; a different seed does not
+    double lowerAgain = 0.0, upperAgain = 0.0;
+    CalculateVaRConfidenceIntervalsSeeded(history.data(), length, 0.99, replicates, 42, &lowerAgain, &upperAgain);
+    assert(lower == lowerAgain && upper == upperAgain);
+    
+    double var = CalculateHistoricalVaR(history.data(), length, 0.99);
+    double bootstrapVar = CalculateBootstrapVaRSeeded(history.data(), length, 0.99, 2000, 42);
+    assert(bootstrapVar == CalculateBootstrapVaRSeeded(history.data(), length, 0.99, 2000, 42));
+    assert(bootstrapVar != CalculateBootstrapVaRSeeded(history.data(), length, 0.99, 2000, 7));
+    assert(lower < upper);
+    assert(lower <= var && var <= upper);
+    assert(approximatelyEqual(bootstrapVar, var, 0.1 * var));
+    
+    std::cout << "✅ Seeded bootstrap test passed: 99% VaR CI [" << lower << ", " << upper << "], "
+              << replicates << " replicates in " << duration.count() << " ms\n";
+}
+
+// Test fused bootstrap statistics
+void testBootstrapStatistics() {
+    std::cout << "Testing fused bootstrap statistics...\n";
+    
+    const int length = 1000, replicates = 2000;
+    std::vector<double> history(length);
+    for (int i = 0; i < length; ++i) {
+        history[i] = 0.015 * std::sin(i * 1.31 + std::cos(i * 0.057)) + 0.003 * std::cos(i * 4.1);
+    }
+    
+    double levels[] = {0.95, 0.99};
+    double percentiles[] = {0.05, 0.5, 0.95};
+    BootstrapSummary var[2], cvar[2];
+    double varBounds[6], cvarBounds[6];
+    CalculateBootstrapVaRStatistics(history.data(), length, levels, 2, replicates, percentiles, 3, BOOTSTRAP_RESAMPLE, 42,
+                                    var, cvar, varBounds, cvarBounds);
+    
+    // One run reproduces the single-level engines for the same seed
+    for (int level = 0; level < 2; ++level) {
+        double lower = 0.0, upper = 0.0;
+        CalculateVaRConfidenceIntervalsSeeded(history.data(), length, levels[level], replicates, 42, &lower, &upper);
+        assert(varBounds[level * 3] == lower && varBounds[level * 3 + 2] == upper);
+        assert(approximatelyEqual(var[level].mean,
+                                  CalculateBootstrapVaRSeeded(history.data(), length, levels[level], replicates, 42), 1e-12));
+        
+        assert(varBounds[level * 3] <= var[level].median && var[level].median <= varBounds[level * 3 + 2]);
+        assert(cvarBounds[level * 3] <= cvar[level].median && cvar[level].median <= cvarBounds[level * 3 + 2]);
+        assert(cvar[level].mean >= var[level].mean);
+        assert(var[level].standardError > 0.0 && cvar[level].standardError > 0.0);
+        assert(approximatelyEqual(var[level].median, varBounds[level * 3 + 1], var[level].standardError));
+    }
+    assert(var[1].mean > var[0].mean);
+    
+    // CVaR alone, and an invalid level reporting zeros
+    double mixed[] = {0.99, 1.5};
+    BootstrapSummary cvarOnly[2];
+    CalculateBootstrapVaRStatistics(history.data(), length, mixed, 2, replicates, nullptr, 0, BOOTSTRAP_RESAMPLE, 42,
+                                    nullptr, cvarOnly, nullptr, nullptr);
+    assert(approximatelyEqual(cvarOnly[0].mean, cvar[1].mean, 1e-12));
+    assert(cvarOnly[1].mean == 0.0 && cvarOnly[1].median == 0.0);
+    
+    std::cout << "✅ Fused bootstrap test passed: 99% VaR " << var[1].mean << " (se " << var[1].standardError
+              << "), 99% CVaR " << cvar[1].mean << " (se " << cvar[1].standardError << ")\n";
+}
+
+// Test count-based bootstrap over the sorted sample
+void testSortedCountBootstrap() {
+    std::cout << "Testing sorted-count bootstrap...\n";
+    
+    const int length = 2500, replicates = 10000;
+    std::vector<double> history(length);
+    for (int i = 0; i < length; ++i) {
+        history[i] = 0.012 * std::sin(i * 0.73 + std::cos(i * 0.031)) + 0.004 * std::cos(i * 2.9);
+    }
+    
+    double levels[] = {0.95, 0.99};
+    double percentiles[] = {0.05, 0.95};
+    BootstrapSummary var[2], cvar[2], countVar[2], countCVaR[2];
+    double countBounds[4];
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateBootstrapVaRStatistics(history.data(), length, levels, 2, replicates, percentiles, 2,
+                                    BOOTSTRAP_RESAMPLE, 42, var, cvar, nullptr, nullptr);
+    auto middle = std::chrono::high_resolution_clock::now();
+    CalculateBootstrapVaRStatistics(history.data(), length, levels, 2, replicates, percentiles, 2,
+                                    BOOTSTRAP_SORTED_COUNTS, 42, countVar, countCVaR, countBounds, nullptr);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto resampleTime = std::chrono::duration_cast<std::chrono::milliseconds>(middle - start);
+    auto countTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - middle);
+    
+    // Both methods sample the same bootstrap distribution
+    for (int level = 0; level < 2; ++level) {
+        double tolerance = 0.1 * var[level].standardError;
+        assert(approximatelyEqual(countVar[level].mean, var[level].mean, tolerance));
+        assert(approximatelyEqual(countCVaR[level].mean, cvar[level].mean, 0.1 * cvar[level].standardError));
+        assert(approximatelyEqual(countVar[level].standardError, var[level].standardError,
+                                  0.1 * var[level].standardError));
+        assert(countBounds[level * 2] <= countVar[level].median && countVar[level].median <= countBounds[level * 2 + 1]);
+    }
+    
+    // Reproducible for a seed
+    BootstrapSummary again[2];
+    CalculateBootstrapVaRStatistics(history.data(), length, levels, 2, replicates, nullptr, 0,
+                                    BOOTSTRAP_SORTED_COUNTS, 42, again, nullptr, nullptr, nullptr);
+    assert(again[0].mean == countVar[0].mean && again[1].standardError == countVar[1].standardError);
+    
+    // Both branches of the portable binomial draw match the binomial moments
+    const int draws = 20000;
+    for (int trials : {40, 1000}) {
+        const double p = 0.2;
+        RiskKernels::RandomStream stream(7, static_cast<unsigned long long>(trials));
+        double sum = 0.0, sumSq = 0.0;
+        for (int i = 0; i < draws; ++i) {
+            const int k = stream.nextBinomial(trials, p);
+            assert(k >= 0 && k <= trials);
+            sum += k;
+            sumSq += static_cast<double>(k) * k;
+        }
+        const double mean = sum / draws, variance = sumSq / draws - mean * mean;
+        const double expectedVariance = trials * p * (1.0 - p);
+        assert(approximatelyEqual(mean, trials * p, 5.0 * std::sqrt(expectedVariance / draws)));
+        assert(approximatelyEqual(variance, expectedVariance, 0.05 * expectedVariance));
+    }
+    
+    std::cout << "✅ Sorted-count bootstrap test passed: " << replicates << " replicates in "
+              << countTime.count() << " ms (resampling: " << resampleTime.count() << " ms)\n";
+}
+
 // Test VaR confidence intervals
 void testVaRConfidenceIntervals() {
     std::cout << "Testing VaR confidence intervals...\n";
@@ -151,6 +381,791 @@ void testVaRDecomposition() {
               << ", Asset 2 contribution = " << contributions[1] << "\n";
 }
 
+// Test Euler VaR/ES decomposition
+void testEulerDecomposition() {
+    std::cout << "Testing Euler VaR decomposition...\n";
+    
+    const int numAssets = 2000, length = 1000;
+    std::vector<double> assetReturns(static_cast<size_t>(numAssets) * length);
+    std::vector<double> weights(numAssets);
+    for (int j = 0; j < numAssets; ++j) {
+        weights[j] = (1.0 + (j % 7)) / (4.0 * numAssets);
+        for (int t = 0; t < length; ++t) {
+            double market = 0.01 * std::sin(t * 0.37 + std::cos(t * 0.011));
+            double specific = 0.02 * std::sin(t * (0.91 + 0.0013 * j) + j);
+            assetReturns[static_cast<size_t>(j) * length + t] = (0.5 + 0.001 * (j % 500)) * market + specific;
+        }
+    }
+    
+    std::vector<double> portfolio(length, 0.0);
+    for (int j = 0; j < numAssets; ++j) {
+        for (int t = 0; t < length; ++t) {
+            portfolio[t] += weights[j] * assetReturns[static_cast<size_t>(j) * length + t];
+        }
+    }
+    
+    double var = 0.0, es = 0.0;
+    std::vector<double> marginalVaR(numAssets), componentVaR(numAssets), marginalES(numAssets), componentES(numAssets);
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateEulerVaRDecomposition(assetReturns.data(), weights.data(), numAssets, length, 0.99, 0.0,
+                                   &var, &es, marginalVaR.data(), componentVaR.data(),
+                                   marginalES.data(), componentES.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    
+    assert(approximatelyEqual(var, CalculateHistoricalVaR(portfolio.data(), length, 0.99), 1e-12));
+    assert(approximatelyEqual(es, CalculateHistoricalCVaR(portfolio.data(), length, 0.99), 1e-12));
+    
+    // Components add up to the portfolio figures
+    double varTotal = 0.0, esTotal = 0.0;
+    for (int j = 0; j < numAssets; ++j) {
+        varTotal += componentVaR[j];
+        esTotal += componentES[j];
+        assert(approximatelyEqual(componentVaR[j], weights[j] * marginalVaR[j], 1e-15));
+    }
+    assert(approximatelyEqual(varTotal, var, 1e-12));
+    assert(approximatelyEqual(esTotal, es, 1e-12));
+    
+    // Kernel smoothing: components add up to the kernel-smoothed portfolio VaR,
+    // which stays close to the single-scenario estimate
+    std::vector<double> smoothed(numAssets);
+    CalculateEulerVaRDecomposition(assetReturns.data(), weights.data(), numAssets, length, 0.99, 0.001,
+                                   nullptr, nullptr, nullptr, smoothed.data(), nullptr, nullptr);
+    double smoothedTotal = 0.0;
+    for (double component : smoothed) smoothedTotal += component;
+    assert(approximatelyEqual(smoothedTotal, var, 0.1 * var));
+    
+    // Kernel marginals are the kernel-weighted average returns, also where the
+    // smoothed quantile is near zero (low confidence, wide bandwidth)
+    const int pairLength = 2000;
+    std::vector<double> pair(2 * pairLength), pairWeights = {0.5, 0.5}, pairPortfolio(pairLength);
+    RiskKernels::RandomStream stream(11, 0);
+    for (double& value : pair) value = 0.02 * (stream.nextUniform() - 0.5);
+    for (int t = 0; t < pairLength; ++t) pairPortfolio[t] = 0.5 * (pair[t] + pair[pairLength + t]);
+    for (double bandwidth : {0.0005, 0.02}) {
+        double pairVaR = 0.0;
+        double pairMarginal[2], pairComponent[2];
+        CalculateEulerVaRDecomposition(pair.data(), pairWeights.data(), 2, pairLength, 0.52, bandwidth,
+                                       &pairVaR, nullptr, pairMarginal, pairComponent, nullptr, nullptr);
+        assert(approximatelyEqual(pairVaR, CalculateHistoricalVaR(pairPortfolio.data(), pairLength, 0.52), 1e-15));
+        
+        double kernelTotal = 0.0, kernelSum[2] = {0.0, 0.0}, kernelPortfolio = 0.0;
+        for (int t = 0; t < pairLength; ++t) {
+            double z = (pairPortfolio[t] + pairVaR) / bandwidth;
+            if (std::abs(z) > 4.0) continue;
+            double k = std::exp(-0.5 * z * z);
+            kernelTotal += k;
+            kernelSum[0] += k * pair[t];
+            kernelSum[1] += k * pair[pairLength + t];
+            kernelPortfolio += k * pairPortfolio[t];
+        }
+        for (int j = 0; j < 2; ++j) {
+            assert(approximatelyEqual(pairMarginal[j], -kernelSum[j] / kernelTotal, 1e-15));
+            assert(std::abs(pairMarginal[j]) < 0.01);
+        }
+        assert(approximatelyEqual(pairComponent[0] + pairComponent[1], -kernelPortfolio / kernelTotal, 1e-15));
+        assert(std::abs(pairComponent[0] + pairComponent[1] - pairVaR) < 0.001);
+    }
+    
+    std::cout << "✅ Euler decomposition test passed: " << numAssets << " assets x " << length
+              << " days in " << duration.count() << " ms, 99% VaR = " << var << "\n";
+}
+
+// Test many-portfolio VaR over a shared scenario matrix
+void testPortfolioBatchVaR() {
+    std::cout << "Testing portfolio batch VaR...\n";
+    
+    const int numScenarios = 1259, numAssets = 203, numPortfolios = 1001;
+    std::vector<double> scenarios(static_cast<size_t>(numScenarios) * numAssets);
+    for (int t = 0; t < numScenarios; ++t) {
+        double market = 0.01 * std::sin(t * 0.29 + std::cos(t * 0.017));
+        for (int a = 0; a < numAssets; ++a) {
+            scenarios[static_cast<size_t>(t) * numAssets + a] = (0.4 + 0.005 * (a % 100)) * market
+                                                               + 0.015 * std::sin(t * (1.1 + 0.003 * a) + a);
+        }
+    }
+    std::vector<double> weights(static_cast<size_t>(numAssets) * numPortfolios);
+    for (int a = 0; a < numAssets; ++a) {
+        for (int p = 0; p < numPortfolios; ++p) {
+            weights[static_cast<size_t>(a) * numPortfolios + p] = (1.0 + ((a * 7 + p * 13) % 11)) / (6.0 * numAssets);
+        }
+    }
+    
+    double levels[] = {0.95, 1.2, 0.99};
+    std::vector<double> var(numPortfolios * 3), cvar(numPortfolios * 3);
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculatePortfolioBatchVaR(scenarios.data(), numScenarios, numAssets, weights.data(), numPortfolios,
+                               levels, 3, var.data(), cvar.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    
+    // Spot-check portfolios, including the last partial block, against the single-portfolio path
+    for (int p : {0, 7, 63, 64, 500, numPortfolios - 1}) {
+        std::vector<double> pnl(numScenarios, 0.0);
+        for (int t = 0; t < numScenarios; ++t) {
+            for (int a = 0; a < numAssets; ++a) {
+                pnl[t] += scenarios[static_cast<size_t>(t) * numAssets + a] * weights[static_cast<size_t>(a) * numPortfolios + p];
+            }
+        }
+        double expectedVaR[3], expectedCVaR[3];
+        CalculateHistoricalVaRLevels(pnl.data(), numScenarios, levels, 3, expectedVaR, expectedCVaR);
+        for (int level = 0; level < 3; ++level) {
+            assert(approximatelyEqual(var[p * 3 + level], expectedVaR[level], 1e-12));
+            assert(approximatelyEqual(cvar[p * 3 + level], expectedCVaR[level], 1e-12));
+        }
+        assert(var[p * 3 + 1] == 0.0 && cvar[p * 3 + 1] == 0.0);
+    }
+    
+    std::cout << "✅ Portfolio batch VaR test passed: " << numPortfolios << " portfolios x " << numAssets
+              << " assets x " << numScenarios << " scenarios in " << duration.count() << " ms\n";
+}
+
+// Test age-weighted and volatility-weighted historical VaR
+void testWeightedHistoricalVaR() {
+    std::cout << "Testing weighted historical VaR...\n";
+    
+    const int length = 1500;
+    std::vector<double> returns(length);
+    for (int t = 0; t < length; ++t) {
+        double regime = t > 1200 ? 2.0 : 1.0;
+        returns[t] = regime * 0.01 * std::sin(t * 0.83 + std::cos(t * 0.021));
+    }
+    
+    double lambdas[] = {0.97, 0.99, 1.0, 1.5};
+    double levels[] = {0.95, 0.99};
+    std::vector<double> var(8), es(8);
+    CalculateAgeWeightedVaR(returns.data(), length, lambdas, 4, levels, 2, var.data(), es.data());
+    
+    // Brute force: sort (return, weight) pairs and walk the cumulative weight
+    for (int k = 0; k < 3; ++k) {
+        std::vector<std::pair<double, double>> weighted(length);
+        double total = 0.0;
+        for (int t = 0; t < length; ++t) {
+            weighted[t] = {returns[t], std::pow(lambdas[k], length - 1 - t)};
+            total += weighted[t].second;
+        }
+        std::sort(weighted.begin(), weighted.end());
+        for (int level = 0; level < 2; ++level) {
+            double alpha = 1.0 - levels[level], cumulative = 0.0, tail = 0.0;
+            for (const auto& observation : weighted) {
+                double weight = observation.second / total;
+                if (cumulative + weight > alpha) {
+                    assert(approximatelyEqual(var[k * 2 + level], -observation.first, 1e-12));
+                    assert(approximatelyEqual(es[k * 2 + level], -(tail + (alpha - cumulative) * observation.first) / alpha, 1e-10));
+                    break;
+                }
+                cumulative += weight;
+                tail += weight * observation.first;
+            }
+        }
+    }
+    // Recent turbulence gets more weight with faster decay
+    assert(var[0] > var[4]);
+    assert(var[6] == 0.0 && es[7] == 0.0);
+    
+    // Hull-White against rescaling by hand
+    double ewma[] = {0.94};
+    double hwVaR[2], hwES[2];
+    CalculateVolatilityWeightedVaR(returns.data(), length, ewma, 1, levels, 2, hwVaR, hwES);
+    double mean = 0.0;
+    for (double r : returns) mean += r;
+    mean /= length;
+    double variance = 0.0;
+    for (double r : returns) variance += (r - mean) * (r - mean);
+    variance /= (length - 1);
+    std::vector<double> sigma(length);
+    for (int t = 0; t < length; ++t) {
+        sigma[t] = std::sqrt(variance);
+        variance = 0.94 * variance + 0.06 * returns[t] * returns[t];
+    }
+    std::vector<double> scaled(length);
+    for (int t = 0; t < length; ++t) scaled[t] = returns[t] * std::sqrt(variance) / sigma[t];
+    double expectedVaR[2], expectedES[2];
+    CalculateHistoricalVaRLevels(scaled.data(), length, levels, 2, expectedVaR, expectedES);
+    for (int level = 0; level < 2; ++level) {
+        assert(approximatelyEqual(hwVaR[level], expectedVaR[level], 1e-10));
+        assert(approximatelyEqual(hwES[level], expectedES[level], 1e-10));
+    }
+    
+    std::cout << "✅ Weighted historical VaR test passed: BRW(0.97) 99% VaR = " << var[1]
+              << ", Hull-White 99% VaR = " << hwVaR[1] << "\n";
+}
+
+// Test GARCH filtered historical simulation
+void testFilteredHistoricalVaR() {
+    std::cout << "Testing filtered historical simulation...\n";
+    
+    // Two assets driven by GARCH(1,1) with correlated shocks
+    const int length = 3000;
+    std::mt19937 generator(7);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> assetReturns(2 * length);
+    double variance[2] = {1e-4, 2e-4};
+    for (int t = 0; t < length; ++t) {
+        double common = normal(generator);
+        for (int a = 0; a < 2; ++a) {
+            double z = 0.7 * common + std::sqrt(1.0 - 0.49) * normal(generator);
+            double e = std::sqrt(variance[a]) * z;
+            assetReturns[a * length + t] = 0.0003 + e;
+            variance[a] = (a == 0 ? 5e-6 : 1e-5) + 0.08 * e * e + 0.87 * variance[a];
+        }
+    }
+    
+    GarchFit fit;
+    assert(FitGARCH11(assetReturns.data(), length, &fit) == 1);
+    assert(std::abs(fit.alpha - 0.08) < 0.04 && std::abs(fit.beta - 0.87) < 0.06);
+    assert(fit.forecastVolatility > 0.0);
+    
+    double levels[] = {0.95, 0.99};
+    double var[2], es[2];
+    GarchFit reported;
+    CalculateFilteredHistoricalVaR(assetReturns.data(), length, levels, 2, var, es, &reported);
+    assert(reported.alpha == fit.alpha && reported.forecastVolatility == fit.forecastVolatility);
+    assert(var[1] > var[0] && es[1] >= var[1]);
+    
+    // A one-asset portfolio over one day is the single-series result
+    double weight[] = {1.0};
+    double portfolioVaR[2], portfolioES[2];
+    CalculatePortfolioFilteredHistoricalVaR(assetReturns.data(), weight, 1, length, 1, 0, 0, levels, 2,
+                                            portfolioVaR, portfolioES);
+    assert(approximatelyEqual(portfolioVaR[1], var[1], 1e-12) && approximatelyEqual(portfolioES[1], es[1], 1e-12));
+    
+    // Ten-day paths resample joint residuals; reproducible and wider than one day
+    double weights[] = {0.6, 0.4};
+    double oneDay[2], tenDay[2], again[2];
+    CalculatePortfolioFilteredHistoricalVaR(assetReturns.data(), weights, 2, length, 1, 0, 0, levels, 2, oneDay, nullptr);
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculatePortfolioFilteredHistoricalVaR(assetReturns.data(), weights, 2, length, 10, 20000, 42, levels, 2, tenDay, nullptr);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    CalculatePortfolioFilteredHistoricalVaR(assetReturns.data(), weights, 2, length, 10, 20000, 42, levels, 2, again, nullptr);
+    assert(tenDay[0] == again[0] && tenDay[1] == again[1]);
+    assert(tenDay[1] > 2.0 * oneDay[1] && tenDay[1] < 5.0 * oneDay[1]);
+    
+    std::cout << "✅ Filtered historical simulation test passed: alpha = " << fit.alpha << ", beta = " << fit.beta
+              << ", 10-day 99% VaR = " << tenDay[1] << " (" << duration.count() << " ms)\n";
+}
+
+// Test incremental what-if VaR
+void testIncrementalVaR() {
+    std::cout << "Testing incremental VaR engine...\n";
+    
+    const int numScenarios = 2500, numCandidates = 500;
+    std::vector<double> portfolio(numScenarios);
+    for (int t = 0; t < numScenarios; ++t) {
+        portfolio[t] = 0.01 * std::sin(t * 0.61 + std::cos(t * 0.043)) + 0.002 * std::cos(t * 3.7);
+    }
+    std::vector<double> candidates(static_cast<size_t>(numCandidates) * numScenarios);
+    std::vector<double> sizes(numCandidates);
+    for (int c = 0; c < numCandidates; ++c) {
+        for (int t = 0; t < numScenarios; ++t) {
+            candidates[static_cast<size_t>(c) * numScenarios + t] = 0.01 * std::sin(t * (0.3 + 0.001 * c) + c);
+        }
+        // Mostly small trades, plus a few large enough to reshuffle the tail
+        sizes[c] = c % 50 == 0 ? 5.0 : 0.05 * ((c % 7) - 3);
+    }
+    
+    IncrementalVaREngine* engine = CreateIncrementalVaREngine(portfolio.data(), numScenarios, 0.99);
+    assert(engine != nullptr);
+    assert(CreateIncrementalVaREngine(portfolio.data(), numScenarios, 1.0) == nullptr);
+    double baseVaR = 0.0, baseES = 0.0;
+    QueryIncrementalVaR(engine, &baseVaR, &baseES);
+    assert(approximatelyEqual(baseVaR, CalculateHistoricalVaR(portfolio.data(), numScenarios, 0.99), 1e-15));
+    assert(approximatelyEqual(baseES, CalculateHistoricalCVaR(portfolio.data(), numScenarios, 0.99), 1e-12));
+    
+    std::vector<double> newVaR(numCandidates), newES(numCandidates), deltaVaR(numCandidates);
+    auto start = std::chrono::high_resolution_clock::now();
+    EvaluateIncrementalVaR(engine, candidates.data(), sizes.data(), numCandidates,
+                           newVaR.data(), newES.data(), deltaVaR.data(), nullptr);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    std::vector<double> combined(numScenarios);
+    for (int c = 0; c < numCandidates; ++c) {
+        for (int t = 0; t < numScenarios; ++t) {
+            combined[t] = portfolio[t] + sizes[c] * candidates[static_cast<size_t>(c) * numScenarios + t];
+        }
+        assert(approximatelyEqual(newVaR[c], CalculateHistoricalVaR(combined.data(), numScenarios, 0.99), 1e-15));
+        assert(approximatelyEqual(newES[c], CalculateHistoricalCVaR(combined.data(), numScenarios, 0.99), 1e-12));
+        assert(approximatelyEqual(deltaVaR[c], newVaR[c] - baseVaR, 1e-15));
+    }
+    
+    // Booking a trade moves the base to that candidate's figures
+    AddIncrementalVaRPosition(engine, candidates.data() + 3 * numScenarios, sizes[3]);
+    double bookedVaR = 0.0;
+    QueryIncrementalVaR(engine, &bookedVaR, nullptr);
+    assert(approximatelyEqual(bookedVaR, newVaR[3], 1e-15));
+    DestroyIncrementalVaREngine(engine);
+    
+    std::cout << "✅ Incremental VaR test passed: " << numCandidates << " candidates x " << numScenarios
+              << " scenarios in " << duration.count() << " us\n";
+}
+
+// Test AS241 inverse normal, Student-t quantiles and batch parametric VaR/ES
+void testBatchParametricVaR() {
+    std::cout << "Testing batch parametric VaR...\n";
+    
+    assert(approximatelyEqual(RiskKernels::inverseNormal(0.95), 1.6448536269514722, 1e-14));
+    assert(approximatelyEqual(RiskKernels::inverseNormal(0.975), 1.9599639845400540, 1e-14));
+    assert(approximatelyEqual(RiskKernels::inverseNormal(0.01), -2.3263478740408408, 1e-14));
+    assert(approximatelyEqual(RiskKernels::inverseNormal(1e-10), -6.3613409024040557, 1e-12));
+    for (double p = 0.0005; p < 1.0; p += 0.0005) {
+        double z = RiskKernels::inverseNormal(p);
+        assert(std::abs(0.5 * std::erfc(-z / std::sqrt(2.0)) - p) < 1e-14);
+    }
+    for (double x : {1e-6, 0.1, 0.5, 1.0, 2.5, 9.99, 10.0, 37.3, 1e4, 1e7}) {
+        assert(std::abs(RiskKernels::logGamma(x) - std::lgamma(x)) < 1e-13 * std::max(1.0, std::abs(std::lgamma(x))));
+    }
+    assert(approximatelyEqual(RiskKernels::studentTQuantile(0.99, 5.0), 3.364929999, 1e-8));
+    assert(approximatelyEqual(RiskKernels::studentTQuantile(0.975, 10.0), 2.228138852, 1e-8));
+    assert(approximatelyEqual(RiskKernels::studentTQuantile(0.01, 3.0), -4.540702859, 1e-8));
+    
+    // Legacy single-asset functions use the exact quantile at any level
+    double mean = 0.0, variance = 0.0;
+    for (double r : testReturns) mean += r;
+    mean /= testReturns.size();
+    for (double r : testReturns) variance += (r - mean) * (r - mean);
+    double stdDev = std::sqrt(variance / (testReturns.size() - 1));
+    assert(approximatelyEqual(CalculateParametricVaR(testReturns.data(), testReturns.size(), 0.975),
+                              -(mean - 1.9599639845400540 * stdDev), 1e-14));
+    
+    // Negatively skewed, fat-tailed assets
+    const int numAssets = 300, length = 1500;
+    std::vector<double> assets(static_cast<size_t>(numAssets) * length);
+    for (int a = 0; a < numAssets; ++a) {
+        for (int t = 0; t < length; ++t) {
+            double u = std::sin(t * 0.37 + a) * std::cos(t * 0.011 * (1 + a % 5));
+            double jump = (t * 7 + a) % 97 == 0 ? -0.04 : 0.0;
+            assets[static_cast<size_t>(a) * length + t] = 0.0004 + 0.01 * (1.0 + 0.002 * a) * u + jump;
+        }
+    }
+    std::vector<double> levels = {0.95, 0.99, 1.5, 0.975};
+    const int numLevels = static_cast<int>(levels.size());
+    std::vector<double> var(numAssets * numLevels), es(numAssets * numLevels);
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateBatchParametricVaR(assets.data(), numAssets, length, levels.data(), numLevels,
+                                PARAMETRIC_NORMAL, 0.0, var.data(), es.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::vector<double> singleVaR(numLevels), singleES(numLevels);
+    for (int a = 0; a < numAssets; ++a) {
+        CalculateParametricVaRLevels(assets.data() + static_cast<size_t>(a) * length, length, levels.data(), numLevels,
+                                     singleVaR.data(), singleES.data());
+        for (int l = 0; l < numLevels; ++l) {
+            assert(approximatelyEqual(var[a * numLevels + l], singleVaR[l], 1e-12));
+            assert(approximatelyEqual(es[a * numLevels + l], singleES[l], 1e-12));
+        }
+    }
+    assert(var[2] == 0.0 && es[2] == 0.0);
+    
+    // Cornish-Fisher and Student-t: more tail loss than the normal at 99%, and
+    // ES equal to the average VaR over the tail (midpoint rule in the tail probability)
+    std::vector<double> cfVaR(numAssets * numLevels), cfES(numAssets * numLevels);
+    CalculateBatchParametricVaR(assets.data(), numAssets, length, levels.data(), numLevels,
+                                PARAMETRIC_CORNISH_FISHER, 0.0, cfVaR.data(), cfES.data());
+    std::vector<double> tVaR(numAssets * numLevels), tES(numAssets * numLevels);
+    CalculateBatchParametricVaR(assets.data(), numAssets, length, levels.data(), numLevels,
+                                PARAMETRIC_STUDENT_T, 0.0, tVaR.data(), tES.data());
+    assert(cfVaR[1] > var[1] && cfES[1] > es[1]);
+    assert(tVaR[1] > var[1] && tES[1] > es[1]);
+    
+    const int grid = 4000;
+    std::vector<double> tailLevels(grid);
+    for (int i = 0; i < grid; ++i) tailLevels[i] = 1.0 - 0.01 * (i + 0.5) / grid;
+    for (int model : {PARAMETRIC_CORNISH_FISHER, PARAMETRIC_STUDENT_T}) {
+        std::vector<double> gridVaR(grid);
+        CalculateBatchParametricVaR(assets.data(), 1, length, tailLevels.data(), grid, model, 0.0,
+                                    gridVaR.data(), nullptr);
+        double average = 0.0;
+        for (double value : gridVaR) average += value / grid;
+        double shortfall = model == PARAMETRIC_CORNISH_FISHER ? cfES[1] : tES[1];
+        assert(std::abs(average - shortfall) < 1e-3 * shortfall);
+    }
+    
+    // A fixed nu uses the t quantile scaled to the sample variance
+    CalculateBatchParametricVaR(assets.data(), 1, length, levels.data(), numLevels,
+                                PARAMETRIC_STUDENT_T, 5.0, tVaR.data(), nullptr);
+    double assetSigma = (var[1] - var[0]) / (2.3263478740408408 - 1.6448536269514722);
+    double assetMean = 1.6448536269514722 * assetSigma - var[0];
+    assert(approximatelyEqual(tVaR[1], -(assetMean - assetSigma * std::sqrt(0.6) * 3.364929999), 1e-8));
+    
+    std::cout << "✅ Batch parametric VaR test passed: " << numAssets << " assets x " << length
+              << " observations in " << duration.count() << " us\n";
+}
+
+// Test multi-horizon VaR against explicitly built overlapping returns
+void testMultiHorizonVaR() {
+    std::cout << "Testing multi-horizon VaR...\n";
+    
+    const int length = 2520;
+    std::vector<double> returns(length);
+    std::mt19937 generator(2024);
+    std::student_t_distribution<double> noise(4.0);
+    for (int t = 0; t < length; ++t) returns[t] = 0.0003 + 0.008 * noise(generator);
+    
+    std::vector<int> horizons = {1, 5, 10, 21, 0, length};
+    std::vector<double> levels = {0.95, 0.99, 1.0};
+    const int numHorizons = static_cast<int>(horizons.size()), numLevels = static_cast<int>(levels.size());
+    std::vector<double> var(numHorizons * numLevels), es(numHorizons * numLevels);
+    std::vector<double> compoundedVaR(numHorizons * numLevels);
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateMultiHorizonVaR(returns.data(), length, horizons.data(), numHorizons, levels.data(), numLevels,
+                             HORIZON_ADDITIVE, var.data(), es.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    CalculateMultiHorizonVaR(returns.data(), length, horizons.data(), numHorizons, levels.data(), numLevels,
+                             HORIZON_COMPOUNDED, compoundedVaR.data(), nullptr);
+    
+    std::vector<double> expectedVaR(numLevels), expectedES(numLevels), expectedCompounded(numLevels);
+    for (int k = 0; k < 4; ++k) {
+        const int h = horizons[k];
+        std::vector<double> summed, compounded;
+        for (int t = 0; t + h <= length; ++t) {
+            double sum = 0.0, growth = 1.0;
+            for (int i = t; i < t + h; ++i) {
+                sum += returns[i];
+                growth *= 1.0 + returns[i];
+            }
+            summed.push_back(sum);
+            compounded.push_back(growth - 1.0);
+        }
+        const int windows = static_cast<int>(summed.size());
+        CalculateHistoricalVaRLevels(summed.data(), windows, levels.data(), numLevels,
+                                     expectedVaR.data(), expectedES.data());
+        CalculateHistoricalVaRLevels(compounded.data(), windows, levels.data(), numLevels,
+                                     expectedCompounded.data(), nullptr);
+        for (int l = 0; l < numLevels; ++l) {
+            const double tolerance = h == 1 ? 0.0 : 1e-12;
+            assert(std::abs(var[k * numLevels + l] - expectedVaR[l]) <= tolerance);
+            assert(std::abs(es[k * numLevels + l] - expectedES[l]) <= tolerance);
+            assert(std::abs(compoundedVaR[k * numLevels + l] - expectedCompounded[l]) <= 1e-12);
+        }
+    }
+    // Horizon 0 and a horizon leaving one window report 0
+    for (int index = 4 * numLevels; index < numHorizons * numLevels; ++index) {
+        assert(var[index] == 0.0 && es[index] == 0.0);
+    }
+    assert(var[3 * numLevels + 1] > var[1 * numLevels + 1] && var[1 * numLevels + 1] > var[1]);
+    
+    std::cout << "✅ Multi-horizon VaR test passed: 21-day 99% VaR = " << var[3 * numLevels + 1]
+              << " vs 1-day " << var[1] << " (" << duration.count() << " us)\n";
+}
+
+// Test the rolling VaR backtest: forecasts, coverage statistics and traffic lights
+void testVaRBacktest() {
+    std::cout << "Testing VaR backtest...\n";
+    
+    // Exceptions placed by hand: window minimum is the 99% VaR of a 50-day
+    // window, and each planted loss is deeper than every earlier one
+    const int window = 50, days = 250;
+    auto plantedSeries = [&](int count, bool clustered) {
+        std::vector<double> series(window + days);
+        for (int t = 0; t < window + days; ++t) series[t] = 0.001 + 0.0001 * (t % 7);
+        for (int k = 0; k < count; ++k) series[window + (clustered ? 100 + k : 20 + 23 * k)] = -(k + 1.0);
+        return series;
+    };
+    const int zones[][2] = {{0, TRAFFIC_LIGHT_GREEN}, {4, TRAFFIC_LIGHT_GREEN}, {5, TRAFFIC_LIGHT_YELLOW},
+                            {9, TRAFFIC_LIGHT_YELLOW}, {10, TRAFFIC_LIGHT_RED}};
+    for (const auto& zone : zones) {
+        std::vector<double> series = plantedSeries(zone[0], false);
+        VaRBacktestStatistics stats;
+        BacktestVaR(series.data(), 1, window + days, window, 0.99, BACKTEST_HISTORICAL, &stats, nullptr);
+        assert(stats.observations == days && stats.exceptions == zone[0]);
+        assert(stats.trafficLight == zone[1]);
+    }
+    VaRBacktestStatistics none, spaced, clustered;
+    std::vector<double> series = plantedSeries(0, false);
+    BacktestVaR(series.data(), 1, window + days, window, 0.99, BACKTEST_HISTORICAL, &none, nullptr);
+    assert(approximatelyEqual(none.kupiecStatistic, -2.0 * days * std::log(0.99), 1e-12));
+    assert(approximatelyEqual(none.cumulativeProbability, std::pow(0.99, days), 1e-12));
+    series = plantedSeries(4, false);
+    BacktestVaR(series.data(), 1, window + days, window, 0.99, BACKTEST_HISTORICAL, &spaced, nullptr);
+    series = plantedSeries(4, true);
+    BacktestVaR(series.data(), 1, window + days, window, 0.99, BACKTEST_HISTORICAL, &clustered, nullptr);
+    assert(approximatelyEqual(spaced.kupiecStatistic, clustered.kupiecStatistic, 1e-12));
+    assert(clustered.christoffersenStatistic > 10.0 && clustered.christoffersenPValue < 0.01);
+    assert(spaced.christoffersenStatistic < clustered.christoffersenStatistic);
+    assert(approximatelyEqual(clustered.conditionalCoverageStatistic,
+                              clustered.kupiecStatistic + clustered.christoffersenStatistic, 1e-12));
+    
+    // Volatility-clustered assets: forecasts against the rolling and single-window functions
+    const int numAssets = 64, length = 2000, windowLength = 250;
+    std::vector<double> assets(static_cast<size_t>(numAssets) * length);
+    std::mt19937 generator(99);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    for (int a = 0; a < numAssets; ++a) {
+        double variance = 1e-4;
+        for (int t = 0; t < length; ++t) {
+            double r = std::sqrt(variance) * normal(generator);
+            assets[static_cast<size_t>(a) * length + t] = r;
+            variance = 2e-6 + 0.1 * r * r + 0.88 * variance;
+        }
+    }
+    std::vector<VaRBacktestStatistics> stats(numAssets);
+    std::vector<double> forecasts(static_cast<size_t>(numAssets) * length);
+    double level = 0.99;
+    std::vector<double> rolling(length);
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    BacktestVaR(assets.data(), numAssets, length, windowLength, level, BACKTEST_HISTORICAL, stats.data(), forecasts.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    for (int a = 0; a < numAssets; a += 9) {
+        const double* returns = assets.data() + static_cast<size_t>(a) * length;
+        const double* forecast = forecasts.data() + static_cast<size_t>(a) * length;
+        CalculateRollingHistoricalVaR(const_cast<double*>(returns), length, windowLength, &level, 1, rolling.data(), nullptr);
+        int exceptions = 0;
+        for (int t = windowLength; t < length; ++t) {
+            assert(forecast[t] == rolling[t - 1]);
+            exceptions += returns[t] < -forecast[t] ? 1 : 0;
+        }
+        assert(std::isnan(forecast[windowLength - 1]));
+        assert(stats[a].exceptions == exceptions && stats[a].observations == length - windowLength);
+    }
+    
+    BacktestVaR(assets.data(), numAssets, length, windowLength, level, BACKTEST_PARAMETRIC, stats.data(), forecasts.data());
+    for (int t = windowLength; t < length; t += 97) {
+        double expected = CalculateParametricVaR(assets.data() + t - windowLength, windowLength, level);
+        assert(approximatelyEqual(forecasts[t], expected, 1e-12));
+    }
+    
+    // The filtered model tracks the volatility clusters: fewer exceptions in clusters
+    std::vector<VaRBacktestStatistics> filtered(numAssets);
+    BacktestVaR(assets.data(), numAssets, length, windowLength, level, BACKTEST_FILTERED_HISTORICAL,
+                filtered.data(), nullptr);
+    double historicalLR = 0.0, filteredLR = 0.0;
+    BacktestVaR(assets.data(), numAssets, length, windowLength, level, BACKTEST_HISTORICAL, stats.data(), nullptr);
+    for (int a = 0; a < numAssets; ++a) {
+        historicalLR += stats[a].christoffersenStatistic;
+        filteredLR += filtered[a].christoffersenStatistic;
+    }
+    assert(filteredLR < historicalLR);
+    
+    // Empty input and a window covering the whole series zero the statistics
+    assert(stats[0].observations > 0);
+    BacktestVaR(nullptr, numAssets, 0, windowLength, level, BACKTEST_HISTORICAL, stats.data(), nullptr);
+    assert(stats[0].observations == 0 && stats[numAssets - 1].exceptions == 0);
+    BacktestVaR(assets.data(), numAssets, length, windowLength, level, BACKTEST_HISTORICAL, stats.data(), nullptr);
+    BacktestVaR(assets.data(), numAssets, length, length, level, BACKTEST_HISTORICAL, stats.data(), nullptr);
+    assert(stats[0].observations == 0 && stats[0].exceptions == 0);
+    
+    std::cout << "✅ VaR backtest test passed: " << numAssets << " assets x " << length << " days in "
+              << duration.count() << " ms\n";
+}
+
+// Test the peaks-over-threshold GPD tail estimator
+void testExtremeValueVaR() {
+    std::cout << "Testing extreme value VaR...\n";
+    
+    // Student-t(3) returns: tail index 3, so the loss tail has shape 1/3
+    const int numAssets = 40, length = 2500;
+    std::vector<double> assets(static_cast<size_t>(numAssets) * length);
+    std::mt19937 generator(31);
+    std::student_t_distribution<double> studentT(3.0);
+    for (double& r : assets) r = 0.01 * studentT(generator);
+    
+    GpdTailFit fit;
+    assert(FitGPDTail(assets.data(), length, 0.1, &fit) == 1);
+    assert(fit.exceedances == 250 && fit.shape > 0.1 && fit.shape < 0.6 && fit.scale > 0.0);
+    
+    // The fit is a maximum of the GPD log-likelihood
+    std::vector<double> exceedances;
+    for (int t = 0; t < length; ++t) {
+        if (-assets[t] > fit.threshold) exceedances.push_back(-assets[t] - fit.threshold);
+    }
+    assert(static_cast<int>(exceedances.size()) == fit.exceedances);
+    auto logLikelihood = [&](double xi, double beta) {
+        double total = -static_cast<double>(exceedances.size()) * std::log(beta);
+        for (double y : exceedances) total -= (1.0 + 1.0 / xi) * std::log1p(xi * y / beta);
+        return total;
+    };
+    assert(approximatelyEqual(logLikelihood(fit.shape, fit.scale), fit.logLikelihood, 1e-8));
+    for (double dXi : {-0.01, 0.0, 0.01}) {
+        for (double dBeta : {0.99, 1.0, 1.01}) {
+            assert(logLikelihood(fit.shape + dXi, fit.scale * dBeta) <= fit.logLikelihood + 1e-9);
+        }
+    }
+    
+    // Batch equals single-series calls; levels inside the threshold report 0
+    std::vector<double> levels = {0.999, 0.9999, 0.8, 0.995};
+    const int numLevels = static_cast<int>(levels.size());
+    std::vector<double> var(numAssets * numLevels), es(numAssets * numLevels);
+    std::vector<GpdTailFit> fits(numAssets);
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateBatchExtremeValueVaR(assets.data(), numAssets, length, 0.1, levels.data(), numLevels,
+                                  var.data(), es.data(), fits.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::vector<double> singleVaR(numLevels), singleES(numLevels);
+    for (int a = 0; a < numAssets; ++a) {
+        CalculateExtremeValueVaR(assets.data() + static_cast<size_t>(a) * length, length, 0.1, levels.data(), numLevels,
+                                 singleVaR.data(), singleES.data(), &fit);
+        assert(fit.shape == fits[a].shape);
+        for (int l = 0; l < numLevels; ++l) {
+            assert(var[a * numLevels + l] == singleVaR[l] && es[a * numLevels + l] == singleES[l]);
+        }
+        assert(singleVaR[2] == 0.0 && singleES[2] == 0.0);
+        assert(singleES[0] > singleVaR[0] && singleVaR[1] > singleVaR[0] && singleVaR[0] > singleVaR[3]);
+    }
+    
+    // Across the samples the 99.9% POT VaR scatters less around the true
+    // quantile (t3: 10.2145) than the historical order statistic
+    const double trueVaR = 0.01 * 10.21453;
+    double evtError = 0.0, historicalError = 0.0;
+    for (int a = 0; a < numAssets; ++a) {
+        double historical = CalculateHistoricalVaR(assets.data() + static_cast<size_t>(a) * length, length, 0.999);
+        evtError += (var[a * numLevels] - trueVaR) * (var[a * numLevels] - trueVaR);
+        historicalError += (historical - trueVaR) * (historical - trueVaR);
+    }
+    assert(evtError < historicalError);
+    
+    // Threshold stability: each threshold's figures match a fit at that fraction
+    std::vector<double> fractions = {0.02, 0.05, 0.1, 0.15, 0.001};
+    const int numThresholds = static_cast<int>(fractions.size());
+    std::vector<double> shape(numThresholds), shapeError(numThresholds), modifiedScale(numThresholds);
+    std::vector<double> thresholdVaR(numThresholds);
+    CalculateGPDThresholdStability(assets.data(), length, fractions.data(), numThresholds, 0.999,
+                                   shape.data(), shapeError.data(), modifiedScale.data(), thresholdVaR.data());
+    for (int i = 0; i < 4; ++i) {
+        double level = 0.999, single = 0.0;
+        CalculateExtremeValueVaR(assets.data(), length, fractions[i], &level, 1, &single, nullptr, &fit);
+        assert(shape[i] == fit.shape && thresholdVaR[i] == single);
+        assert(approximatelyEqual(modifiedScale[i], fit.scale - fit.shape * fit.threshold, 1e-15));
+        assert(approximatelyEqual(shapeError[i], (1.0 + fit.shape) / std::sqrt(fit.exceedances), 1e-15));
+    }
+    assert(shape[4] == 0.0 && thresholdVaR[4] == 0.0);
+    
+    // Exponential losses have shape near 0
+    std::exponential_distribution<double> exponential(100.0);
+    std::vector<double> exponentialReturns(length);
+    for (double& r : exponentialReturns) r = -exponential(generator);
+    assert(FitGPDTail(exponentialReturns.data(), length, 0.2, &fit) == 1);
+    assert(std::abs(fit.shape) < 0.15 && std::abs(fit.scale - 0.01) < 0.003);
+    
+    // All-zero exceedances fail; equal nonzero exceedances are fitted
+    std::vector<double> flat(200, -0.01);
+    assert(FitGPDTail(flat.data(), 200, 0.1, &fit) == 0 && fit.exceedances == 0);
+    for (int i = 0; i < 20; ++i) flat[i] = -0.05;
+    assert(FitGPDTail(flat.data(), 200, 0.1, &fit) == 1 && fit.exceedances == 20 && fit.shape >= -0.5);
+    
+    std::cout << "✅ Extreme value VaR test passed: shape = " << fits[0].shape << ", 99.9% VaR = " << var[0]
+              << " (" << numAssets << " series in " << duration.count() << " us)\n";
+}
+
+// Test Harrell-Davis and kernel-smoothed historical VaR
+void testSmoothedHistoricalVaR() {
+    std::cout << "Testing smoothed historical VaR...\n";
+    
+    const int length = 1000;
+    std::vector<double> returns(length);
+    std::mt19937 generator(7);
+    std::student_t_distribution<double> noise(4.0);
+    for (double& r : returns) r = 0.01 * noise(generator);
+    std::vector<double> levels = {0.95, 0.99, 0.0, 0.975};
+    const int numLevels = static_cast<int>(levels.size());
+    
+    // The empirical option is the historical order statistic
+    std::vector<double> empirical(numLevels), historical(numLevels);
+    CalculateSmoothedHistoricalVaR(returns.data(), length, levels.data(), numLevels, QUANTILE_EMPIRICAL, empirical.data());
+    CalculateHistoricalVaRLevels(returns.data(), length, levels.data(), numLevels, historical.data(), nullptr);
+    for (int l = 0; l < numLevels; ++l) assert(empirical[l] == historical[l]);
+    
+    // Harrell-Davis against the full weight vector over the sorted sample
+    std::vector<double> sorted = returns;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<double> harrellDavis(numLevels), kernel(numLevels);
+    CalculateSmoothedHistoricalVaR(returns.data(), length, levels.data(), numLevels, QUANTILE_HARRELL_DAVIS,
+                                   harrellDavis.data());
+    CalculateSmoothedHistoricalVaR(returns.data(), length, levels.data(), numLevels, QUANTILE_KERNEL, kernel.data());
+    for (int l : {0, 1, 3}) {
+        const double p = 1.0 - levels[l];
+        const double a = p * (length + 1), b = (1.0 - p) * (length + 1);
+        double expected = 0.0, previous = 0.0;
+        for (int i = 1; i <= length; ++i) {
+            double current = i == length ? 1.0 : RiskKernels::incompleteBeta(static_cast<double>(i) / length, a, b);
+            expected += (current - previous) * sorted[i - 1];
+            previous = current;
+        }
+        assert(approximatelyEqual(harrellDavis[l], -expected, 1e-14));
+        
+        // Both smoothers stay among the order statistics around the quantile
+        const int index = static_cast<int>(p * length);
+        assert(kernel[l] < -sorted[index - 10] && kernel[l] > -sorted[index + 10]);
+    }
+    assert(harrellDavis[2] == 0.0 && kernel[2] == 0.0);
+    
+    // Over a rolling one-year window the smoothed VaR moves less day to day
+    const int window = 250;
+    double level = 0.99, empiricalMoves = 0.0, smoothedMoves = 0.0;
+    double previousEmpirical = 0.0, previousSmoothed = 0.0;
+    for (int t = 0; t + window <= length; ++t) {
+        double e = 0.0, h = 0.0;
+        CalculateSmoothedHistoricalVaR(returns.data() + t, window, &level, 1, QUANTILE_EMPIRICAL, &e);
+        CalculateSmoothedHistoricalVaR(returns.data() + t, window, &level, 1, QUANTILE_HARRELL_DAVIS, &h);
+        if (t > 0) {
+            empiricalMoves += std::abs(e - previousEmpirical);
+            smoothedMoves += std::abs(h - previousSmoothed);
+        }
+        previousEmpirical = e;
+        previousSmoothed = h;
+    }
+    assert(smoothedMoves < empiricalMoves);
+    
+    // Batch with shared weights equals single-series calls
+    const int numAssets = 200;
+    std::vector<double> assets(static_cast<size_t>(numAssets) * length);
+    for (double& r : assets) r = 0.01 * noise(generator);
+    std::vector<double> batch(numAssets * numLevels), single(numLevels);
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateBatchSmoothedHistoricalVaR(assets.data(), numAssets, length, levels.data(), numLevels,
+                                        QUANTILE_HARRELL_DAVIS, batch.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    for (int a = 0; a < numAssets; a += 13) {
+        CalculateSmoothedHistoricalVaR(assets.data() + static_cast<size_t>(a) * length, length, levels.data(), numLevels,
+                                       QUANTILE_HARRELL_DAVIS, single.data());
+        for (int l = 0; l < numLevels; ++l) assert(batch[a * numLevels + l] == single[l]);
+    }
+    
+    std::cout << "✅ Smoothed historical VaR test passed: 99% VaR empirical = " << empirical[1]
+              << ", Harrell-Davis = " << harrellDavis[1] << ", kernel = " << kernel[1] << " (" << numAssets
+              << " series in " << duration.count() << " us)\n";
+}
+
+// Test rolling VaR/CVaR against per-window historical calculations
+void testRollingHistoricalVaR() {
+    std::cout << "Testing rolling historical VaR...\n";
+    
+    const int length = 700, window = 252;
+    std::vector<double> returns(length);
+    for (int i = 0; i < length; ++i) {
+        // Include repeated values so ties are exercised
+        returns[i] = std::round(1000.0 * 0.02 * std::sin(i * 0.91 + std::cos(i * 0.13))) / 1000.0;
+    }
+    
+    std::vector<double> levels = {0.95, 0.99, 0.975};
+    const int numLevels = static_cast<int>(levels.size());
+    std::vector<double> var(numLevels * length), cvar(numLevels * length);
+    CalculateRollingHistoricalVaR(returns.data(), length, window, levels.data(), numLevels, var.data(), cvar.data());
+    
+    for (int level = 0; level < numLevels; ++level) {
+        for (int t = 0; t < length; ++t) {
+            int out = level * length + t;
+            if (t < window - 1) {
+                assert(std::isnan(var[out]) && std::isnan(cvar[out]));
+                continue;
+            }
+            double* slice = returns.data() + t - window + 1;
+            assert(var[out] == CalculateHistoricalVaR(slice, window, levels[level]));
+            assert(approximatelyEqual(cvar[out], CalculateHistoricalCVaR(slice, window, levels[level]), 1e-12));
+        }
+    }
+    
+    std::cout << "✅ Rolling historical VaR test passed: last 99% VaR = " << var[2 * length - 1] << "\n";
+}
+
 // Test edge cases
 void testEdgeCases() {
     std::cout << "Testing edge cases...\n";
@@ -239,12 +1254,29 @@ int main() {
     try {
         testHistoricalVaR();
         testHistoricalCVaR();
+        testHistoricalVaRSelection();
+        testVaRLevels();
+        testFloatHistoricalVaR();
         testParametricVaR();
         testParametricCVaR();
         testBootstrapVaR();
         testVaRConfidenceIntervals();
+        testSeededBootstrap();
+        testBootstrapStatistics();
+        testSortedCountBootstrap();
         testPortfolioVaR();
         testVaRDecomposition();
+        testEulerDecomposition();
+        testPortfolioBatchVaR();
+        testWeightedHistoricalVaR();
+        testFilteredHistoricalVaR();
+        testIncrementalVaR();
+        testBatchParametricVaR();
+        testMultiHorizonVaR();
+        testVaRBacktest();
+        testExtremeValueVaR();
+        testSmoothedHistoricalVaR();
+        testRollingHistoricalVaR();
         testEdgeCases();
         testPerformance();
         testMethodComparison();